@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    AutomationBench.cpp
+    Created: 17 Oct 2026 12:53:41pm
+    Author:  Kevin Kopczynski
+
+    Added cost of ramping automated comb parameters across each block with
+    Synth::setCombRamp(), against setting them once per block. Resonance,
+    spread and curve move every block, as under dense host automation,
+    while eight voices play.
+
+    CMake target AutomationBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/synth/Synth.h"
+
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr int numVoices = 8;
+    constexpr double seconds = 2.0;
+    constexpr int chord[] = { 36, 43, 48, 52, 55, 60, 64, 67 };
+    
+    // an LFO over every continuous comb parameter, 0.5 Hz
+    CombProcessor::Parameters automation(int sample, CombProcessor::Engine engine)
+    {
+        auto phase = std::sin(Tau * 0.5f * float(sample / sampleRate));
+        
+        return CombProcessor::Parameters(-1.0f, jmap(phase, -1.0f, 1.0f, RESONANCE_MIN, RESONANCE_MAX), TIMBRE_DEFAULT, jmap(phase, -1.0f, 1.0f, -3.0f, CURVE_MAX),
+                                         jmap(phase, -1.0f, 1.0f, 0.9f, 1.1f), GLIDE_MIN, CombProcessor::FreqOutOfBoundsMode::Ignore, HARMONICS_DEFAULT, engine);
+    }
+    
+    // nanoseconds per sample for the whole synth, best of three runs
+    double measure(int blockSize, CombProcessor::Engine engine, bool split)
+    {
+        Synth synth;
+        synth.addSound(new SynthSound());
+        synth.setCurrentPlaybackSampleRate(sampleRate);
+        
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto voice = new SynthVoice();
+            voice->prepareToPlay(sampleRate, blockSize, numChannels);
+            voice->getCombProcessor().updateParams(automation(0, engine));
+            synth.addVoice(voice);
+        }
+        
+        synth.prepare(0, false, blockSize);
+        synth.setPolyphony(numVoices);
+        
+        AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                excitation.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        synth.setExcitation(excitation);
+        
+        MidiBuffer notes, none;
+        for (auto note : chord)
+            notes.addEvent(MidiMessage::noteOn(1, note, 1.0f), 0);
+        
+        buffer.clear();
+        synth.renderNextBlock(buffer, notes, 0, blockSize);
+        
+        auto numBlocks = int(seconds * sampleRate) / blockSize;
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // what processBlock does when every block brings new values
+                auto from = automation(block * blockSize, engine);
+                auto to = automation((block + 1) * blockSize, engine);
+                
+                for (auto* voice : synth.getSynthVoices())
+                    voice->getCombProcessor().updateParams(to);
+                
+                if (split)
+                    synth.setCombRamp(from, to, blockSize);
+                
+                buffer.clear();
+                synth.renderNextBlock(buffer, none, 0, blockSize);
+            }
+        });
+    }
+}
+
+int main()
+{
+    std::printf("ns per sample, %d voices, comb updated every %d samples when split\n\n", numVoices, AUTOMATION_INTERVAL);
+    std::printf("%6s %6s %10s %10s %8s\n", "block", "engine", "per block", "split", "added");
+    
+    for (int blockSize : { 64, 256, 1024 })
+    {
+        for (auto engine : { CombProcessor::Engine::SVF, CombProcessor::Engine::Modal, CombProcessor::Engine::Waveguide })
+        {
+            auto whole = measure(blockSize, engine, false);
+            auto split = measure(blockSize, engine, true);
+            
+            std::printf("%6d %6s %10.1f %10.1f %7.1f%%\n", blockSize,
+                        engine == CombProcessor::Engine::SVF ? "svf" : engine == CombProcessor::Engine::Modal ? "modal" : "wg",
+                        whole, split, 100.0 * (split - whole) / whole);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    BankBench.cpp
+    Created: 17 Oct 2026 11:34:18am
+    Author:  Kevin Kopczynski
+
+    Cost per partial per sample of the SVF and modal resonator banks, and
+    per sample of the waveguide comb, which doesn't depend on the number of
+    partials.
+
+    CMake target BankBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/FilterBank.h"
+#include "../Source/audio/ModalBank.h"
+#include "../Source/audio/WaveguideComb.h"
+
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 16;           // one control interval
+    constexpr int numChannels = 2;
+    constexpr int numBlocks = 20000;
+    
+    // nanoseconds per partial per sample, best of three runs
+    double measure(ResonatorBank& bank, int numPartials, bool ramping)
+    {
+        std::vector<float> cutoffs(numPartials), resonances(numPartials), gains(numPartials, 0.1f);
+        
+        for (int i = 0; i < numPartials; ++i)
+        {
+            cutoffs[i] = 110.0f * float(i + 1);
+            resonances[i] = 55.0f * (float(i) / 2.0f + 1.0f);
+        }
+        
+        bank.prepare(sampleRate, numPartials);
+        bank.setCullThreshold(-1000.0f);
+        bank.setCoefficients(cutoffs.data(), resonances.data(), numPartials);
+        bank.setGains(gains.data(), numPartials);
+        
+        AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize * numPartials, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // a glide, so every block ramps all coefficients
+                if (ramping)
+                {
+                    for (auto& cutoff : cutoffs)
+                        cutoff *= (block / 1000) % 2 == 0 ? 1.0001f : 0.9999f;
+                    
+                    bank.setCoefficients(cutoffs.data(), resonances.data(), numPartials);
+                }
+                
+                bank.process(noise.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), numChannels, blockSize);
+            }
+        });
+    }
+    
+    // nanoseconds per sample, best of three runs
+    double measureWaveguide(bool gliding)
+    {
+        WaveguideComb waveguide;
+        waveguide.prepare({ sampleRate, uint32(blockSize), uint32(numChannels) });
+        
+        AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            float freq = 55.0f;
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                if (gliding)
+                    freq *= (block / 1000) % 2 == 0 ? 1.0001f : 0.9999f;
+                
+                waveguide.setParameters(freq, 55.0f, 0.5f, -1.0f);
+                waveguide.process(noise.getArrayOfReadPointers(), buffer.getArrayOfWritePointers(), numChannels, blockSize);
+            }
+        });
+    }
+}
+
+int main()
+{
+    FilterBank svf;
+    ModalBank modal;
+    
+    std::printf("ns per partial per sample, %d channels, %d-sample control interval\n\n", numChannels, blockSize);
+    std::printf("%10s %10s %10s %10s %10s\n", "partials", "svf", "modal", "svf ramp", "modal ramp");
+    
+    for (int numPartials : { 16, 64, 256 })
+    {
+        std::printf("%10d %10.3f %10.3f %10.3f %10.3f\n", numPartials,
+                    measure(svf, numPartials, false), measure(modal, numPartials, false),
+                    measure(svf, numPartials, true), measure(modal, numPartials, true));
+    }
+    
+    std::printf("\nwaveguide, ns per sample: %.3f static, %.3f gliding\n", measureWaveguide(false), measureWaveguide(true));
+    
+    return 0;
+}
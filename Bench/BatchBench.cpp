@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    BatchBench.cpp
+    Created: 17 Oct 2026 12:07:52pm
+    Author:  Kevin Kopczynski
+
+    Cost of a chord of voices rendered one by one against the same voices
+    in CombBatch lanes, both at the host rate without multirate.
+
+    CMake target BatchBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/CombBatch.h"
+
+#include <cstdio>
+#include <memory>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr double seconds = 1.0;
+    // a spread chord, so each voice culls at a different harmonic
+    constexpr int notes[] = { 36, 43, 48, 52, 55, 60, 64, 67 };
+    
+    // nanoseconds per sample for all voices together, best of three runs
+    double measure(int numVoices, int harmonics, CombProcessor::Engine engine, bool batched)
+    {
+        std::vector<std::unique_ptr<CombProcessor>> combs;
+        
+        for (int v = 0; v < numVoices; ++v)
+        {
+            combs.push_back(std::make_unique<CombProcessor>(MAX_NUM_FILTERS));
+            combs[v]->setMultirate(false);
+            combs[v]->prepare({ sampleRate, uint32(blockSize), uint32(numChannels) });
+            combs[v]->updateParams(CombProcessor::Parameters(midiToFreq(notes[v]), RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_MIN,
+                                                             CombProcessor::FreqOutOfBoundsMode::Ignore, harmonics, engine));
+        }
+        
+        OwnedArray<CombBatch> batches;
+        
+        if (batched)
+        {
+            for (int v = 0; v < numVoices; ++v)
+            {
+                if (v % CombBatch::numLanes == 0)
+                    batches.add(new CombBatch())->prepare(sampleRate, blockSize, combs[v]->getNumSlots());
+                
+                batches.getLast()->setLane(v % CombBatch::numLanes, combs[v].get());
+            }
+        }
+        
+        AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize), output(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        auto renderBlock = [&]
+        {
+            output.clear();
+            
+            if (batched)
+            {
+                for (auto* batch : batches)
+                    batch->process(noise.getArrayOfReadPointers(), numChannels, blockSize);
+                
+                for (int v = 0; v < numVoices; ++v)
+                {
+                    batches[v / CombBatch::numLanes]->copyLaneOutput(v % CombBatch::numLanes, buffer.getArrayOfWritePointers(), numChannels, blockSize);
+                    
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        output.addFrom(ch, 0, buffer, ch, 0, blockSize);
+                }
+            }
+            else
+            {
+                for (auto& comb : combs)
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        buffer.copyFrom(ch, 0, noise, ch, 0, blockSize);
+                    
+                    comb->process(buffer, blockSize);
+                    
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        output.addFrom(ch, 0, buffer, ch, 0, blockSize);
+                }
+            }
+        };
+        
+        // let the glide from A440 settle
+        for (int block = 0; block < int(sampleRate) / blockSize; ++block)
+            renderBlock();
+        
+        auto numBlocks = int(seconds * sampleRate) / blockSize;
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                renderBlock();
+        });
+    }
+}
+
+int main()
+{
+    std::printf("ns per sample for all voices, %.0f Hz, %d channels, %d lanes per batch\n\n", sampleRate, numChannels, CombBatch::numLanes);
+    std::printf("%7s %9s %6s %10s %10s %8s\n", "voices", "harmonics", "engine", "per voice", "batched", "speedup");
+    
+    for (int numVoices : { 4, 8 })
+    {
+        for (int harmonics : { 7, HARMONICS_DEFAULT, MAX_NUM_FILTERS })
+        {
+            for (auto engine : { CombProcessor::Engine::SVF, CombProcessor::Engine::Modal })
+            {
+                auto perVoice = measure(numVoices, harmonics, engine, false);
+                auto batched = measure(numVoices, harmonics, engine, true);
+                
+                std::printf("%7d %9d %6s %10.1f %10.1f %7.2fx\n", numVoices, harmonics,
+                            engine == CombProcessor::Engine::SVF ? "svf" : "modal", perVoice, batched, perVoice / batched);
+            }
+        }
+    }
+    
+    return 0;
+}
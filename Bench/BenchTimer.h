@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    BenchTimer.h
+    Created: 17 Oct 2026 1:34:05pm
+    Author:  Kevin Kopczynski
+
+    Timing shared by the benches. Header only, so the CMake build doesn't
+    make a target of it.
+
+  ==============================================================================
+*/
+
+#ifndef BENCHTIMER_H
+#define BENCHTIMER_H
+
+#include <algorithm>
+#include <chrono>
+
+namespace bench
+{
+    // nanoseconds per unit of work of the fastest of numRuns calls to run(),
+    // each of which does numUnits units. The fastest run is the one least
+    // disturbed by the rest of the machine
+    template <typename Run>
+    double bestOf(int numRuns, double numUnits, Run&& run)
+    {
+        double best = 1.0e30;
+        
+        for (int r = 0; r < numRuns; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count() / numUnits);
+        }
+        
+        return best;
+    }
+    
+    // nanoseconds of the slowest of numBlocks calls to block(), the most
+    // one audio callback can cost. The least of numRuns such passes, so a
+    // call the rest of the machine interrupted isn't taken for it
+    template <typename Block>
+    double worstBlock(int numRuns, int numBlocks, Block&& block)
+    {
+        double best = 1.0e30;
+        
+        for (int r = 0; r < numRuns; ++r)
+        {
+            double worst = 0.0;
+            
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                auto start = std::chrono::steady_clock::now();
+                block(b);
+                std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+                worst = std::max(worst, elapsed.count());
+            }
+            
+            best = std::min(best, worst);
+        }
+        
+        return best;
+    }
+}
+
+#endif // BENCHTIMER_H
@@ -0,0 +1,292 @@
+/*
+  ==============================================================================
+
+    CombBankBench.cpp
+    Created: 17 Oct 2026 1:30:38pm
+    Author:  Kevin Kopczynski
+
+    Cost of CombProcessor::process() in ns per sample per partial, over a
+    grid of harmonic counts, block sizes, sample rates, alias modes, voice
+    counts and engines. Each voice is its own CombProcessor on its own
+    note, as the plugin runs them, and the voices are processed one after
+    another. Every row is labelled with the commit the build was configured
+    at, so results from two commits can be diffed or joined.
+
+        CombBankBench [--format csv|json] [--output file] [--quick]
+                      [--harmonics 16,64,256] [--blocks 32,128,512,4096]
+                      [--rates 44100,96000,192000] [--modes ignore,wrap,fold]
+                      [--voices 1,8] [--engines svf,modal,waveguide]
+                      [--seconds 0.1] [--label name]
+
+    CMake target CombBankBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/CombProcessor.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef FINETOOTH_COMMIT
+ #define FINETOOTH_COMMIT "unknown"
+#endif
+
+using namespace audio;
+
+namespace
+{
+    constexpr int numChannels = 2;
+    // high enough that the top harmonics pass Nyquist at 44.1 kHz, where the alias modes differ
+    constexpr int lowestNote = 48;
+    
+    struct Options
+    {
+        std::vector<int> harmonics { 16, 64, 256 };
+        std::vector<int> blockSizes { 32, 128, 512, 4096 };
+        std::vector<int> sampleRates { 44100, 96000, 192000 };
+        std::vector<std::string> modes { "ignore", "wrap", "fold" };
+        std::vector<int> voices { 1, 8 };
+        std::vector<std::string> engines { "svf" };
+        double seconds = 0.1;
+        bool json = false;
+        std::string output, label = FINETOOTH_COMMIT;
+    };
+    
+    struct Result
+    {
+        std::string engine, mode;
+        int sampleRate, blockSize, harmonics, voices, activeSlots;
+        double nsPerSample, nsPerPartial;
+    };
+    
+    std::vector<std::string> split(const char* list)
+    {
+        std::vector<std::string> items;
+        std::string item;
+        
+        for (const char* c = list; ; ++c)
+        {
+            if (*c == ',' || *c == 0)
+            {
+                if (! item.empty())
+                    items.push_back(item);
+                
+                item.clear();
+                
+                if (*c == 0)
+                    return items;
+            }
+            else
+            {
+                item += *c;
+            }
+        }
+    }
+    
+    std::vector<int> splitInts(const char* list)
+    {
+        std::vector<int> values;
+        
+        for (auto& item : split(list))
+            values.push_back(std::atoi(item.c_str()));
+        
+        return values;
+    }
+    
+    CombProcessor::FreqOutOfBoundsMode toMode(const std::string& name)
+    {
+        if (name == "wrap")
+            return CombProcessor::FreqOutOfBoundsMode::Wrap;
+        if (name == "fold")
+            return CombProcessor::FreqOutOfBoundsMode::Fold;
+        
+        return CombProcessor::FreqOutOfBoundsMode::Ignore;
+    }
+    
+    CombProcessor::Engine toEngine(const std::string& name)
+    {
+        if (name == "modal")
+            return CombProcessor::Engine::Modal;
+        if (name == "waveguide")
+            return CombProcessor::Engine::Waveguide;
+        
+        return CombProcessor::Engine::SVF;
+    }
+    
+    // best of three runs of seconds of audio through every voice
+    Result measure(const Options& options, const std::string& engine, int sampleRate, int blockSize, int harmonics, const std::string& mode, int numVoices)
+    {
+        std::vector<std::unique_ptr<CombProcessor>> combs;
+        
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto comb = std::make_unique<CombProcessor>(MAX_NUM_FILTERS);
+            comb->prepare({ double(sampleRate), uint32(blockSize), uint32(numChannels) });
+            comb->updateParams(CombProcessor::Parameters(midiToFreq(lowestNote + (v * 7) % 24), RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT,
+                                                         GLIDE_MIN, toMode(mode), harmonics, toEngine(engine)));
+            combs.push_back(std::move(comb));
+        }
+        
+        AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        // past the glide and the first coefficient ramps
+        for (int pos = 0; pos < sampleRate / 20; pos += blockSize)
+            for (auto& comb : combs)
+                comb->process(noise, buffer, blockSize);
+        
+        auto numBlocks = jmax(1, int(options.seconds * sampleRate) / blockSize);
+        
+        auto best = bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                for (auto& comb : combs)
+                    comb->process(noise, buffer, blockSize);
+        });
+        
+        Result result;
+        result.engine = engine;
+        result.mode = mode;
+        result.sampleRate = sampleRate;
+        result.blockSize = blockSize;
+        result.harmonics = harmonics;
+        result.voices = numVoices;
+        result.activeSlots = combs.front()->getNumActiveHarmonics();
+        result.nsPerSample = best;
+        result.nsPerPartial = best / (double(numVoices) * harmonics);
+        return result;
+    }
+    
+    void write(FILE* file, const Options& options, const std::vector<Result>& results)
+    {
+        if (! options.json)
+        {
+            std::fprintf(file, "label,engine,sample_rate,block_size,harmonics,alias_mode,voices,active_slots,ns_per_sample,ns_per_sample_per_partial\n");
+            
+            for (auto& r : results)
+                std::fprintf(file, "%s,%s,%d,%d,%d,%s,%d,%d,%.3f,%.5f\n", options.label.c_str(), r.engine.c_str(), r.sampleRate, r.blockSize,
+                             r.harmonics, r.mode.c_str(), r.voices, r.activeSlots, r.nsPerSample, r.nsPerPartial);
+            
+            return;
+        }
+        
+        std::fprintf(file, "{\n  \"label\": \"%s\",\n  \"results\": [\n", options.label.c_str());
+        
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            auto& r = results[i];
+            std::fprintf(file, "    { \"engine\": \"%s\", \"sample_rate\": %d, \"block_size\": %d, \"harmonics\": %d, \"alias_mode\": \"%s\", "
+                               "\"voices\": %d, \"active_slots\": %d, \"ns_per_sample\": %.3f, \"ns_per_sample_per_partial\": %.5f }%s\n",
+                         r.engine.c_str(), r.sampleRate, r.blockSize, r.harmonics, r.mode.c_str(), r.voices, r.activeSlots,
+                         r.nsPerSample, r.nsPerPartial, i + 1 < results.size() ? "," : "");
+        }
+        
+        std::fprintf(file, "  ]\n}\n");
+    }
+    
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            auto is = [&] (const char* name) { return std::strcmp(argv[i], name) == 0; };
+            auto value = [&] { return i + 1 < argc ? argv[++i] : ""; };
+            
+            if (is("--format"))
+                options.json = std::strcmp(value(), "json") == 0;
+            else if (is("--output"))
+                options.output = value();
+            else if (is("--label"))
+                options.label = value();
+            else if (is("--harmonics"))
+                options.harmonics = splitInts(value());
+            else if (is("--blocks"))
+                options.blockSizes = splitInts(value());
+            else if (is("--rates"))
+                options.sampleRates = splitInts(value());
+            else if (is("--modes"))
+                options.modes = split(value());
+            else if (is("--voices"))
+                options.voices = splitInts(value());
+            else if (is("--engines"))
+                options.engines = split(value());
+            else if (is("--seconds"))
+                options.seconds = std::atof(value());
+            else if (is("--quick"))
+            {
+                options.harmonics = { 64 };
+                options.blockSizes = { 32, 4096 };
+                options.sampleRates = { 48000 };
+                options.modes = { "ignore" };
+                options.voices = { 1 };
+                options.seconds = 0.02;
+            }
+            else
+            {
+                std::fprintf(stderr, "unknown option %s\n", argv[i]);
+                return false;
+            }
+        }
+        
+        for (auto harmonics : options.harmonics)
+            if (harmonics < HARMONICS_MIN || harmonics > HARMONICS_MAX)
+                return false;
+        for (auto blockSize : options.blockSizes)
+            if (blockSize < 1)
+                return false;
+        for (auto sampleRate : options.sampleRates)
+            if (sampleRate < 8000)
+                return false;
+        for (auto numVoices : options.voices)
+            if (numVoices < 1)
+                return false;
+        
+        return options.seconds > 0.0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    
+    if (! parse(argc, argv, options))
+    {
+        std::fprintf(stderr, "bad arguments, see the top of Bench/CombBankBench.cpp\n");
+        return 1;
+    }
+    
+    std::vector<Result> results;
+    
+    for (auto& engine : options.engines)
+        for (auto sampleRate : options.sampleRates)
+            for (auto blockSize : options.blockSizes)
+                for (auto harmonics : options.harmonics)
+                    for (auto& mode : options.modes)
+                        for (auto numVoices : options.voices)
+                            results.push_back(measure(options, engine, sampleRate, blockSize, harmonics, mode, numVoices));
+    
+    auto* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    
+    if (file == nullptr)
+    {
+        std::fprintf(stderr, "can't write %s\n", options.output.c_str());
+        return 1;
+    }
+    
+    write(file, options, results);
+    
+    if (file != stdout)
+        std::fclose(file);
+    
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    EnvelopeBench.cpp
+    Created: 17 Oct 2026 12:37:37pm
+    Author:  Kevin Kopczynski
+
+    Cost of a voice's envelope and sum into the output: juce::ADSR stepped
+    one sample at a time over the comb's output followed by addFrom(), as
+    SynthVoice used to, against Envelope's block ramps fused into the sum.
+    The notes are short, so most blocks hold a segment boundary.
+
+    CMake target EnvelopeBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/Envelope.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr double seconds = 8.0;
+    // a note on every quarter second, released after a tenth
+    constexpr int noteSpacing = 12000;
+    constexpr int noteLength = 4800;
+    
+    // nanoseconds per sample, best of three runs. render(start, numSamples)
+    // envelopes the comb output into out, on() and off() are the note events
+    template <typename Render, typename On, typename Off>
+    double measure(Render&& render, On&& on, Off&& off)
+    {
+        auto numBlocks = int(seconds * sampleRate) / blockSize;
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // split at the note events the way Synthesiser does
+                auto blockStart = block * blockSize;
+                int done = 0;
+                
+                while (done < blockSize)
+                {
+                    auto pos = (blockStart + done) % noteSpacing;
+                    auto next = pos < noteLength ? noteLength : noteSpacing;
+                    auto num = jmin(blockSize - done, next - pos);
+                    
+                    if (pos == 0)
+                        on();
+                    else if (pos == noteLength)
+                        off();
+                    
+                    render(done, num);
+                    done += num;
+                }
+            }
+        });
+    }
+}
+
+int main()
+{
+    AudioBuffer<float> comb(numChannels, blockSize), scratch(numChannels, blockSize), out(numChannels, blockSize);
+    Random random(1);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int s = 0; s < blockSize; ++s)
+            comb.setSample(ch, s, random.nextFloat() - 0.5f);
+    
+    out.clear();
+    
+    ADSR adsr;
+    adsr.setSampleRate(sampleRate);
+    adsr.setParameters(ADSR::Parameters(0.005f, 0.05f, 0.6f, 0.05f));
+    
+    auto old = measure([&] (int start, int numSamples)
+    {
+        for (int s = start; s < start + numSamples; ++s)
+        {
+            auto gain = adsr.getNextSample();
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                scratch.setSample(ch, s, comb.getSample(ch, s) * gain);
+        }
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            out.addFrom(ch, start, scratch, ch, start, numSamples);
+    },
+    [&] { adsr.noteOn(); }, [&] { adsr.noteOff(); });
+    
+    std::printf("ns per sample, both channels, %d sample blocks\n\n", blockSize);
+    std::printf("%-14s %8.3f\n", "ADSR", old);
+    
+    for (auto shape : { Envelope::Shape::Linear, Envelope::Shape::Exponential })
+    {
+        Envelope envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(Envelope::Parameters(0.005f, 0.05f, 0.6f, 0.05f, shape));
+        std::vector<float> gains(blockSize);
+        
+        auto time = measure([&] (int start, int numSamples)
+        {
+            envelope.render(gains.data() + start, numSamples);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                FloatVectorOperations::addWithMultiply(out.getWritePointer(ch, start), comb.getReadPointer(ch, start), gains.data() + start, numSamples);
+        },
+        [&] { envelope.noteOn(); }, [&] { envelope.noteOff(); });
+        
+        std::printf("%-14s %8.3f %7.2fx\n", shape == Envelope::Shape::Linear ? "linear" : "exponential", time, old / time);
+    }
+    
+    // keeps the sums from being optimised away
+    std::printf("\n(%g)\n", double(out.getSample(0, 0)));
+    return 0;
+}
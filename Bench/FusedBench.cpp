@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    FusedBench.cpp
+    Created: 17 Oct 2026 1:37:09pm
+    Author:  Kevin Kopczynski
+
+    Cost per partial per sample of the filter, gain and accumulate chain
+    CombProcessor used to run, test::PartialChain, next to FilterBank's
+    fused pass over the same partials. Both filter fixed coefficients, so
+    only the kernels differ. The largest difference between their outputs
+    is printed too, FusedFilterTest holds it to a bound.
+
+    CMake target FusedBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/FilterBank.h"
+#include "../Tests/PartialChain.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numChannels = 2;
+    constexpr double seconds = 2.0;
+    
+    test::Partials makePartials(int num)
+    {
+        test::Partials partials;
+        
+        for (int i = 0; i < num; ++i)
+        {
+            partials.cutoffs.push_back(55.0f * float(i + 1));
+            partials.resonances.push_back(20.0f + float(i));
+            partials.timbreGains.push_back(i % 2 == 0 ? 0.75f : 0.25f);
+            partials.curveGains.push_back(1.0f - float(i) / float(num));
+        }
+        
+        return partials;
+    }
+    
+    struct Result
+    {
+        double chain, fused, maxDifference;
+    };
+    
+    // nanoseconds per partial per sample of each, best of three runs
+    Result measure(int numPartials, int blockSize)
+    {
+        auto partials = makePartials(numPartials);
+        test::PartialChain chain(partials, sampleRate, numChannels, blockSize);
+        auto gains = partials.getGains();
+        
+        FilterBank bank;
+        bank.prepare(sampleRate, numPartials);
+        bank.setCullThreshold(-1000.0f);
+        bank.setCoefficients(partials.cutoffs.data(), partials.resonances.data(), numPartials);
+        bank.setGains(gains.data(), numPartials);
+        
+        AudioBuffer<float> noise(numChannels, blockSize), chainOut(numChannels, blockSize), fusedOut(numChannels, blockSize);
+        Random random(1);
+        Result result { 0.0, 0.0, 0.0 };
+        
+        // both from cleared state over the same input, before timing them
+        for (int block = 0; block < 64; ++block)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+            
+            chain.process(noise, chainOut, blockSize);
+            bank.process(noise.getArrayOfReadPointers(), fusedOut.getArrayOfWritePointers(), numChannels, blockSize);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    result.maxDifference = jmax(result.maxDifference, double(std::abs(chainOut.getSample(ch, s) - fusedOut.getSample(ch, s))));
+        }
+        
+        auto numBlocks = jmax(1, int(seconds * sampleRate) / blockSize);
+        auto numUnits = double(numBlocks) * blockSize * numPartials;
+        
+        result.chain = bench::bestOf(3, numUnits, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                chain.process(noise, chainOut, blockSize);
+        });
+        
+        result.fused = bench::bestOf(3, numUnits, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                bank.process(noise.getArrayOfReadPointers(), fusedOut.getArrayOfWritePointers(), numChannels, blockSize);
+        });
+        
+        return result;
+    }
+}
+
+int main()
+{
+    std::printf("ns per partial per sample, %d channels\n\n", numChannels);
+    std::printf("%10s %10s %10s %10s %10s %12s\n", "partials", "block", "chain", "fused", "speedup", "max diff dB");
+    
+    for (int numPartials : { 16, 64, 256 })
+    {
+        for (int blockSize : { 32, 128, 512 })
+        {
+            auto result = measure(numPartials, blockSize);
+            
+            std::printf("%10d %10d %10.3f %10.3f %9.2fx %12.1f\n", numPartials, blockSize, result.chain, result.fused,
+                        result.chain / result.fused, Decibels::gainToDecibels(result.maxDifference, -200.0));
+        }
+    }
+    
+    return 0;
+}
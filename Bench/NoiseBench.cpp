@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    NoiseBench.cpp
+    Created: 17 Oct 2026 12:24:02pm
+    Author:  Kevin Kopczynski
+
+    Cost of filling the Noise mode excitation one Random::nextFloat() and
+    setSample() at a time, as processBlock used to, against NoiseGenerator
+    in each colour. Then the slowest single block of each colour, playing
+    on across colour segments and right after a jump to the end of one,
+    which replays the most, against the time a block lasts.
+
+    CMake target NoiseBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/NoiseGenerator.h"
+
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 96000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr double seconds = 4.0;
+    // long enough to cross several colour segments
+    constexpr double worstCaseSeconds = 20.0;
+    
+    // nanoseconds per sample and channel, best of three runs
+    template <typename Fill>
+    double measure(Fill&& fill)
+    {
+        auto numBlocks = int(seconds * sampleRate) / blockSize;
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize * numChannels, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                fill();
+        });
+    }
+}
+
+int main()
+{
+    AudioBuffer<float> buffer(numChannels, blockSize);
+    Random random;
+    
+    auto old = measure([&]
+    {
+        buffer.clear();
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                buffer.setSample(ch, s, random.nextFloat() * 0.5f);
+    });
+    
+    std::printf("ns per sample and channel, %d sample blocks\n\n", blockSize);
+    std::printf("%-14s %8.3f\n", "setSample", old);
+    
+    NoiseGenerator noise;
+    noise.prepare(sampleRate);
+    
+    for (auto colour : { NoiseGenerator::Colour::White, NoiseGenerator::Colour::Pink, NoiseGenerator::Colour::Brown })
+    {
+        noise.setColour(colour);
+        
+        auto time = measure([&] { noise.process(buffer.getArrayOfWritePointers(), numChannels, blockSize); });
+        
+        std::printf("%-14s %8.3f %7.2fx\n", colour == NoiseGenerator::Colour::White ? "white" : colour == NoiseGenerator::Colour::Pink ? "pink" : "brown",
+                    time, old / time);
+    }
+    
+    auto numBlocks = int(worstCaseSeconds * sampleRate) / blockSize;
+    auto segmentLength = uint64(NoiseGenerator::colourSegmentSeconds * sampleRate);
+    
+    std::printf("\nslowest block in us, a block lasts %.0f us\n\n", blockSize / sampleRate * 1.0e6);
+    std::printf("%-14s %8s %8s\n", "", "playing", "jump");
+    
+    for (auto colour : { NoiseGenerator::Colour::Pink, NoiseGenerator::Colour::Brown })
+    {
+        noise.setColour(colour);
+        noise.reset();
+        
+        auto playing = bench::worstBlock(3, numBlocks, [&] (int)
+        {
+            noise.process(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+        });
+        
+        // each block a jump to a different segment, ending a block short of it
+        auto jump = bench::worstBlock(3, 16, [&] (int block)
+        {
+            noise.setPosition(uint64(block + 1) * segmentLength * 3 - uint64(blockSize) - 1);
+            noise.process(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+        });
+        
+        std::printf("%-14s %8.1f %8.1f\n", colour == NoiseGenerator::Colour::Pink ? "pink" : "brown", playing / 1000.0, jump / 1000.0);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    VoiceBench.cpp
+    Created: 17 Oct 2026 11:58:13am
+    Author:  Kevin Kopczynski
+
+    Cost of one voice's CombProcessor with and without the multirate
+    subbands, at the high sample rates where most partials sit far below
+    Nyquist.
+
+    CMake target VoiceBench, not part of the plugin. Build it in Release.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchTimer.h"
+#include "../Source/audio/CombProcessor.h"
+
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr double seconds = 1.0;
+    
+    // nanoseconds per sample for one voice, best of three runs
+    double measure(double sampleRate, float freq, int harmonics, CombProcessor::Engine engine, bool multirate, int& latency)
+    {
+        CombProcessor comb(MAX_NUM_FILTERS);
+        comb.setMultirate(multirate);
+        comb.prepare({ sampleRate, uint32(blockSize), uint32(numChannels) });
+        comb.updateParams(CombProcessor::Parameters(freq, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_MIN,
+                                                    CombProcessor::FreqOutOfBoundsMode::Ignore, harmonics, engine));
+        latency = comb.getLatency();
+        
+        AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < blockSize; ++s)
+                noise.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+        
+        // let the glide from A440 settle
+        for (int block = 0; block < int(sampleRate) / blockSize; ++block)
+            comb.process(noise, buffer, blockSize);
+        
+        auto numBlocks = int(seconds * sampleRate) / blockSize;
+        
+        return bench::bestOf(3, double(numBlocks) * blockSize, [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                comb.process(noise, buffer, blockSize);
+        });
+    }
+}
+
+int main()
+{
+    std::printf("ns per sample for one voice, %d channels\n\n", numChannels);
+    std::printf("%8s %6s %9s %6s %10s %10s %8s %9s\n", "rate", "note", "harmonics", "engine", "full rate", "multirate", "speedup", "latency");
+    
+    for (double sampleRate : { 88200.0, 96000.0, 192000.0 })
+    {
+        for (int note : { 33, 57 })
+        {
+            for (int harmonics : { HARMONICS_DEFAULT, MAX_NUM_FILTERS })
+            {
+                for (auto engine : { CombProcessor::Engine::SVF, CombProcessor::Engine::Modal })
+                {
+                    int latency = 0;
+                    auto full = measure(sampleRate, midiToFreq(note), harmonics, engine, false, latency);
+                    auto split = measure(sampleRate, midiToFreq(note), harmonics, engine, true, latency);
+                    
+                    std::printf("%8.0f %6.0f %9d %6s %10.1f %10.1f %7.2fx %6d smp\n", sampleRate, midiToFreq(note), harmonics,
+                                engine == CombProcessor::Engine::SVF ? "svf" : "modal", full, split, full / split, latency);
+                }
+            }
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 17 Oct 2026 1:11:34pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+Optional<AudioPlayHead::PositionInfo> OfflineRenderer::PlayHead::getPosition() const
+{
+    PositionInfo info;
+    info.setIsPlaying(true);
+    info.setTimeInSamples(position);
+    info.setTimeInSeconds(double(position) / sampleRate);
+    return info;
+}
+
+OfflineRenderer::OfflineRenderer(const RenderSettings& renderSettings)
+    : settings(renderSettings)
+{
+    formatManager.registerBasicFormats();
+    
+    playHead.sampleRate = settings.sampleRate;
+    processor.setPlayHead(&playHead);
+    processor.setNonRealtime(true);
+    processor.setNumRenderThreads(settings.numRenderThreads);
+    processor.setVoiceBatching(settings.voiceBatching);
+    processor.setAutomationSplitting(settings.automationSplitting);
+    processor.getStateInformation(defaultState);
+}
+
+RenderResult OfflineRenderer::render(const RenderJob& job)
+{
+    RenderResult result;
+    auto startTime = Time::getMillisecondCounterHiRes();
+    
+    MidiMessageSequence sequence;
+    if (! readMidi(job.midiFile, sequence, result.error))
+        return result;
+    
+    // the input is streamed through a resampler to the render rate
+    std::unique_ptr<AudioFormatReaderSource> readerSource;
+    std::unique_ptr<ResamplingAudioSource> input;
+    int64 inputLength = 0;
+    
+    if (job.inputFile != File())
+    {
+        auto reader = formatManager.createReaderFor(job.inputFile);
+        if (reader == nullptr)
+        {
+            result.error = "can't read " + job.inputFile.getFullPathName();
+            return result;
+        }
+        
+        inputLength = roundToInt64(double(reader->lengthInSamples) * settings.sampleRate / reader->sampleRate);
+        
+        auto ratio = reader->sampleRate / settings.sampleRate;
+        readerSource = std::make_unique<AudioFormatReaderSource>(reader, true);
+        input = std::make_unique<ResamplingAudioSource>(readerSource.get(), false, 2);
+        input->setResamplingRatio(ratio);
+        input->prepareToPlay(settings.blockSize, settings.sampleRate);
+    }
+    
+    // every job starts from the same processor, voices, noise and parameters
+    processor.releaseResources();
+    processor.setStateInformation(defaultState.getData(), int(defaultState.getSize()));
+    
+    if (job.stateFile != File() && ! loadState(job.stateFile, result.error))
+        return result;
+    
+    // the input reaches the processor on its sidechain, and plays in Ext mode
+    if (auto bus = processor.getBus(true, 0))
+        bus->enable(input != nullptr);
+    else if (input != nullptr)
+    {
+        result.error = "the processor has no input bus";
+        return result;
+    }
+    
+    if (input != nullptr)
+        processor.setInputMode(1);
+    
+    processor.setRateAndBufferSizeDetails(settings.sampleRate, settings.blockSize);
+    processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+    
+    job.outputFile.deleteFile();
+    job.outputFile.getParentDirectory().createDirectory();
+    
+    auto stream = job.outputFile.createOutputStream();
+    std::unique_ptr<AudioFormatWriter> writer;
+    
+    if (stream != nullptr)
+    {
+        WavAudioFormat wav;
+        writer.reset(wav.createWriterFor(stream.get(), settings.sampleRate, 2, settings.bitDepth, {}, 0));
+        
+        // the writer owns the stream once it has been made
+        if (writer != nullptr)
+            stream.release();
+    }
+    
+    if (writer == nullptr)
+    {
+        result.error = "can't write " + job.outputFile.getFullPathName();
+        return result;
+    }
+    
+    auto numChannels = jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+    AudioBuffer<float> buffer(numChannels, settings.blockSize);
+    MidiBuffer midi;
+    
+    // the last event needs a block of its own to play in
+    auto contentLength = jmax(inputLength, sequence.getNumEvents() > 0 ? roundToInt64(sequence.getEndTime() * settings.sampleRate) + 1 : int64(0));
+    auto latency = int64(processor.getLatencySamples());
+    // content, tail and latency, known once the content has played
+    int64 renderLength = -1, written = 0;
+    int nextEvent = 0;
+    
+    for (int64 position = 0;; )
+    {
+        if (renderLength < 0 && position >= contentLength)
+        {
+            // a note the file leaves on, as in a loop cut from a longer
+            // part, is released here rather than held through the tail
+            processor.allNotesOff();
+            
+            auto tail = jmin(processor.getTailLengthSeconds(), settings.maxTailSeconds);
+            renderLength = contentLength + roundToInt64(tail * settings.sampleRate) + latency;
+        }
+        
+        if (renderLength >= 0 && position >= renderLength)
+            break;
+        
+        auto numSamples = renderLength < 0 ? settings.blockSize : int(jmin(int64(settings.blockSize), renderLength - position));
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        buffer.clear();
+        
+        if (input != nullptr)
+            input->getNextAudioBlock(AudioSourceChannelInfo(&buffer, 0, numSamples));
+        
+        midi.clear();
+        fillMidi(sequence, nextEvent, position, numSamples, midi);
+        
+        playHead.position = position;
+        processor.processBlock(buffer, midi);
+        
+        // cut the latency off the start, so the output lines up with the MIDI
+        auto skip = int(jlimit(int64(0), int64(numSamples), latency - position));
+        
+        if (skip < numSamples)
+        {
+            if (! writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+            {
+                result.error = "can't write " + job.outputFile.getFullPathName();
+                return result;
+            }
+            
+            written += numSamples - skip;
+        }
+        
+        position += numSamples;
+    }
+    
+    writer.reset();
+    
+    result.ok = true;
+    result.audioSeconds = double(written) / settings.sampleRate;
+    result.wallSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    return result;
+}
+
+bool OfflineRenderer::loadState(const File& file, String& error)
+{
+    MemoryBlock state;
+    if (! file.loadFileAsData(state) || state.getSize() == 0)
+    {
+        error = "can't read " + file.getFullPathName();
+        return false;
+    }
+    
+    // a preset saved as XML is turned into the blob getStateInformation() writes
+    if (static_cast<const char*>(state.getData())[0] == '<')
+    {
+        auto xml = parseXML(file);
+        if (xml == nullptr)
+        {
+            error = "can't parse " + file.getFullPathName();
+            return false;
+        }
+        
+        state.reset();
+        MemoryOutputStream mos(state, false);
+        ValueTree::fromXml(*xml).writeToStream(mos);
+    }
+    
+    if (! ValueTree::readFromData(state.getData(), state.getSize()).isValid())
+    {
+        error = file.getFullPathName() + " isn't a saved state";
+        return false;
+    }
+    
+    processor.setStateInformation(state.getData(), int(state.getSize()));
+    return true;
+}
+
+bool OfflineRenderer::readMidi(const File& file, MidiMessageSequence& sequence, String& error)
+{
+    FileInputStream stream(file);
+    MidiFile midiFile;
+    
+    if (! stream.openedOk() || ! midiFile.readFrom(stream))
+    {
+        error = "can't read " + file.getFullPathName();
+        return false;
+    }
+    
+    // every track on one timeline, in seconds through the tempo map
+    midiFile.convertTimestampTicksToSeconds();
+    
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        sequence.addSequence(*midiFile.getTrack(track), 0.0);
+    
+    return true;
+}
+
+void OfflineRenderer::fillMidi(const MidiMessageSequence& sequence, int& index, int64 blockStart, int blockLength, MidiBuffer& midi) const
+{
+    for (; index < sequence.getNumEvents(); ++index)
+    {
+        auto& message = sequence.getEventPointer(index)->message;
+        auto sample = roundToInt64(message.getTimeStamp() * settings.sampleRate);
+        
+        if (sample >= blockStart + blockLength)
+            break;
+        
+        if (! message.isMetaEvent())
+            midi.addEvent(message, int(jmax(int64(0), sample - blockStart)));
+    }
+}
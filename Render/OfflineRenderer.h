@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 17 Oct 2026 1:11:34pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+#include <memory>
+
+// one file to render: the MIDI to play, the state to play it with and,
+// for Ext mode, the audio to excite the combs with
+struct RenderJob
+{
+    File midiFile, outputFile;
+    // optional, a missing state plays the defaults and a missing input
+    // plays the state's own input mode
+    File stateFile, inputFile;
+};
+
+struct RenderSettings
+{
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int bitDepth = 24;
+    // cap on the processor's tail after the last note or input sample
+    double maxTailSeconds = 30.0;
+    // the processor's own render options, see FineToothMIDIAudioProcessor
+    int numRenderThreads = RENDER_THREADS;
+    bool voiceBatching = VOICE_BATCHING, automationSplitting = AUTOMATION_SPLITTING;
+};
+
+struct RenderResult
+{
+    bool ok = false;
+    String error;
+    double audioSeconds = 0.0, wallSeconds = 0.0;
+    
+    double getRealtimeFactor() const { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+};
+
+/*
+    Plays jobs through one FineToothMIDIAudioProcessor as fast as it will
+    go, one job at a time, for a worker thread of the command line renderer.
+
+    Files are streamed a block at a time, the input through a resampler to
+    the render rate and the output straight to the WAV writer, so memory
+    doesn't grow with the length of a render. Only the MIDI file is read
+    whole. The processor's latency is cut off the start of the output, and
+    the render runs on past the last event for the processor's reported
+    tail, up to maxTailSeconds, with any notes still on released there.
+
+    The processor gets a playhead that is always playing, at the position
+    of the block, so Deterministic states render the same samples every
+    time. Every job starts from the processor's default state, then the
+    job's own.
+
+    Construct and destroy it on the message thread, render() may be called
+    on any one thread at a time.
+*/
+class OfflineRenderer
+{
+public:
+    OfflineRenderer(const RenderSettings& settings);
+    ~OfflineRenderer() {;}
+    
+    RenderResult render(const RenderJob& job);
+
+private:
+    struct PlayHead : public AudioPlayHead
+    {
+        Optional<PositionInfo> getPosition() const override;
+        
+        double sampleRate = 48000.0;
+        int64 position = 0;
+    };
+    
+    bool loadState(const File& file, String& error);
+    bool readMidi(const File& file, MidiMessageSequence& sequence, String& error);
+    // adds the events from index on that fall inside the block, at their offsets
+    // into it, and leaves index at the first one after it
+    void fillMidi(const MidiMessageSequence& sequence, int& index, int64 blockStart, int blockLength, MidiBuffer& midi) const;
+    
+    const RenderSettings settings;
+    FineToothMIDIAudioProcessor processor;
+    PlayHead playHead;
+    AudioFormatManager formatManager;
+    // what the processor starts with, restored before every job
+    MemoryBlock defaultState;
+    
+    JUCE_DECLARE_NON_COPYABLE (OfflineRenderer)
+};
+
+#endif // OFFLINERENDERER_H
@@ -0,0 +1,262 @@
+/*
+  ==============================================================================
+
+    RenderMain.cpp
+    Created: 17 Oct 2026 1:11:34pm
+    Author:  Kevin Kopczynski
+
+    Command line renderer: plays standard MIDI files through the plugin's
+    processor faster than realtime and writes WAVs, for batch sound design
+    without a DAW. Jobs run side by side, one processor per worker thread,
+    and each job's realtime factor is printed as it finishes.
+
+        FineToothRender --midi in.mid --output out.wav [--state preset]
+                        [--input excitation.wav]
+        FineToothRender --jobs jobs.txt
+
+    with, for either
+
+                        [--threads n] [--rate 48000] [--block 512]
+                        [--bits 24] [--max-tail 30] [--render-threads n]
+                        [--batching on|off] [--split-automation on|off]
+
+    The state is a blob saved by getStateInformation(), or the same tree as
+    XML. An input plays in Ext mode, on the processor's sidechain. The last
+    three set the threads each job's processor renders its voices on, its
+    CombBatch voice batching and its automation ramping, all defaulting to
+    the plugin's. A jobs
+    file has one job per line, as key=value pairs with paths relative to
+    the file and quotes around any with spaces, # starts a comment:
+
+        midi=a.mid output=renders/a.wav state=bell.preset
+        midi="b 2.mid" output=renders/b.wav input=strings.wav
+
+    Returns non-zero if any job failed. Built by the CMake build, it isn't
+    part of the plugin.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        RenderSettings settings;
+        RenderJob job;
+        File jobsFile;
+        int numThreads = jmax(1, int(std::thread::hardware_concurrency()));
+        // false once an on|off option has anything else
+        bool valid = true;
+    };
+    
+    File toFile(const File& directory, const String& path)
+    {
+        return path.isEmpty() ? File() : directory.getChildFile(path);
+    }
+    
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        auto directory = File::getCurrentWorkingDirectory();
+        
+        for (int i = 1; i < argc; ++i)
+        {
+            auto is = [&] (const char* name) { return std::strcmp(argv[i], name) == 0; };
+            auto value = [&] { return i + 1 < argc ? argv[++i] : ""; };
+            auto isOn = [&] (const char* text, bool current)
+            {
+                options.valid = options.valid && (std::strcmp(text, "on") == 0 || std::strcmp(text, "off") == 0);
+                return options.valid ? std::strcmp(text, "on") == 0 : current;
+            };
+            
+            if (is("--midi"))
+                options.job.midiFile = toFile(directory, value());
+            else if (is("--output"))
+                options.job.outputFile = toFile(directory, value());
+            else if (is("--state"))
+                options.job.stateFile = toFile(directory, value());
+            else if (is("--input"))
+                options.job.inputFile = toFile(directory, value());
+            else if (is("--jobs"))
+                options.jobsFile = toFile(directory, value());
+            else if (is("--threads"))
+                options.numThreads = std::atoi(value());
+            else if (is("--rate"))
+                options.settings.sampleRate = std::atof(value());
+            else if (is("--block"))
+                options.settings.blockSize = std::atoi(value());
+            else if (is("--bits"))
+                options.settings.bitDepth = std::atoi(value());
+            else if (is("--max-tail"))
+                options.settings.maxTailSeconds = std::atof(value());
+            else if (is("--render-threads"))
+                options.settings.numRenderThreads = std::atoi(value());
+            else if (is("--batching"))
+                options.settings.voiceBatching = isOn(value(), options.settings.voiceBatching);
+            else if (is("--split-automation"))
+                options.settings.automationSplitting = isOn(value(), options.settings.automationSplitting);
+            else
+            {
+                std::fprintf(stderr, "unknown option %s\n", argv[i]);
+                return false;
+            }
+        }
+        
+        auto hasJob = options.job.midiFile != File() && options.job.outputFile != File();
+        
+        return (hasJob != (options.jobsFile != File()))
+                && options.numThreads > 0
+                && options.settings.sampleRate >= 8000.0
+                && options.settings.blockSize > 0
+                && (options.settings.bitDepth == 16 || options.settings.bitDepth == 24 || options.settings.bitDepth == 32)
+                && options.settings.maxTailSeconds >= 0.0
+                && options.settings.numRenderThreads >= 0
+                && options.valid;
+    }
+    
+    bool readJobs(const File& file, std::vector<RenderJob>& jobs)
+    {
+        if (! file.existsAsFile())
+        {
+            std::fprintf(stderr, "can't read %s\n", file.getFullPathName().toRawUTF8());
+            return false;
+        }
+        
+        StringArray lines;
+        file.readLines(lines);
+        
+        auto directory = file.getParentDirectory();
+        
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            auto line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+            if (line.isEmpty())
+                continue;
+            
+            StringArray tokens;
+            tokens.addTokens(line, " \t", "\"");
+            tokens.removeEmptyStrings();
+            
+            RenderJob job;
+            
+            for (auto& token : tokens)
+            {
+                auto key = token.upToFirstOccurrenceOf("=", false, false);
+                auto path = toFile(directory, token.fromFirstOccurrenceOf("=", false, false).unquoted());
+                
+                if (key == "midi")
+                    job.midiFile = path;
+                else if (key == "output")
+                    job.outputFile = path;
+                else if (key == "state")
+                    job.stateFile = path;
+                else if (key == "input")
+                    job.inputFile = path;
+                else
+                {
+                    std::fprintf(stderr, "%s line %d: unknown key %s\n", file.getFileName().toRawUTF8(), i + 1, key.toRawUTF8());
+                    return false;
+                }
+            }
+            
+            if (job.midiFile == File() || job.outputFile == File())
+            {
+                std::fprintf(stderr, "%s line %d: needs a midi and an output\n", file.getFileName().toRawUTF8(), i + 1);
+                return false;
+            }
+            
+            jobs.push_back(job);
+        }
+        
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    
+    if (! parse(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: FineToothRender (--midi file --output file [--state file] [--input file] | --jobs file)\n"
+                             "                       [--threads n] [--rate hz] [--block samples] [--bits 16|24|32] [--max-tail seconds]\n"
+                             "                       [--render-threads n] [--batching on|off] [--split-automation on|off]\n");
+        return 2;
+    }
+    
+    std::vector<RenderJob> jobs;
+    
+    if (options.jobsFile == File())
+        jobs.push_back(options.job);
+    else if (! readJobs(options.jobsFile, jobs))
+        return 2;
+    
+    // the processors need a message manager, and are made and destroyed on
+    // this thread as their message thread, which needn't dispatch anything
+    // while they render
+    ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    auto numWorkers = jmin(options.numThreads, int(jobs.size()));
+    std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+    
+    for (int w = 0; w < numWorkers; ++w)
+        renderers.push_back(std::make_unique<OfflineRenderer>(options.settings));
+    
+    std::atomic<int> nextJob { 0 }, numFailed { 0 };
+    std::mutex printLock;
+    auto startTime = Time::getMillisecondCounterHiRes();
+    double totalAudioSeconds = 0.0;
+    
+    auto work = [&] (OfflineRenderer& renderer)
+    {
+        for (int j = nextJob++; j < int(jobs.size()); j = nextJob++)
+        {
+            auto result = renderer.render(jobs[size_t(j)]);
+            auto name = jobs[size_t(j)].outputFile.getFileName();
+            
+            std::lock_guard<std::mutex> lock(printLock);
+            
+            if (result.ok)
+            {
+                totalAudioSeconds += result.audioSeconds;
+                std::printf("%-32s %9.2f s audio %8.2f s wall %8.1fx realtime\n", name.toRawUTF8(),
+                            result.audioSeconds, result.wallSeconds, result.getRealtimeFactor());
+            }
+            else
+            {
+                ++numFailed;
+                std::printf("%-32s FAILED: %s\n", name.toRawUTF8(), result.error.toRawUTF8());
+            }
+            
+            std::fflush(stdout);
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    
+    for (auto& renderer : renderers)
+        workers.emplace_back(work, std::ref(*renderer));
+    
+    for (auto& worker : workers)
+        worker.join();
+    
+    auto wallSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    
+    std::printf("\n%d of %d jobs on %d threads, %.2f s audio in %.2f s, %.1fx realtime\n", int(jobs.size()) - numFailed.load(), int(jobs.size()),
+                numWorkers, totalAudioSeconds, wallSeconds, wallSeconds > 0.0 ? totalAudioSeconds / wallSeconds : 0.0);
+    
+    renderers.clear();
+    
+    return numFailed == 0 ? 0 : 1;
+}
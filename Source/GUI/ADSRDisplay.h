@@ -19,7 +19,7 @@
 class ADSRDisplay  : public juce::Component
 {
 public:
-    ADSRDisplay(FineToothMIDIAudioProcessor& p) : audioProcessor(p)
+    ADSRDisplay(FineToothMIDIAudioProcessor& p) : audioProcessor(p), parameters(p.apvts)
     {
         attack = ATTACK_DEFAULT;
         decay = DECAY_DEFAULT;
@@ -85,7 +85,11 @@ public:
     
     void updateAll()
     {
-        auto settings = getChainSettings(audioProcessor.apvts);
+        // only redrawn when the envelope moved
+        if (! (parameters.update() & ParameterSnapshot::envelopeChanged))
+            return;
+        
+        auto& settings = parameters.get();
         
         attack = settings.attack;
         decay = settings.decay;
@@ -98,6 +102,7 @@ public:
 private:
     float attack, decay, sustain, release;
     FineToothMIDIAudioProcessor& audioProcessor;
+    ParameterSnapshot parameters;
     
     static constexpr float maxMs = 550.0f;//ATTACK_MAX + DECAY_MAX + RELEASE_MAX + 100.0f - 16.0f;
     
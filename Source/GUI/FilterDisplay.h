@@ -100,20 +100,20 @@ public:
         }
         
     private:
-        Chain chain;
-        
         float freq, resonance, gain;
         audio::CombProcessor::Parameters params;
         audio::CombProcessor::FreqOutOfBoundsMode mode;
         
         static constexpr float inFreq = 50.0f;
-        static constexpr float maxRes = RESONANCE_MAX * (MAX_NUM_FILTERS / 2.0f);
+        // the resonance of the 50th harmonic at full Resonance, which the
+        // band widths were drawn for, whatever MAX_NUM_FILTERS is
+        static constexpr float maxRes = RESONANCE_MAX * (50 / 2.0f);
         
         int harm;
     };
     
     
-    FilterDisplay(FineToothMIDIAudioProcessor& p) : audioProcessor(p)
+    FilterDisplay(FineToothMIDIAudioProcessor& p) : audioProcessor(p), parameters(p.apvts)
     {
         for (int harm = 0; harm < MAX_NUM_FILTERS; ++harm)
         {
@@ -174,11 +174,17 @@ public:
     
     void updateAll()
     {
-        auto settings = getChainSettings(audioProcessor.apvts);
+        if (! (parameters.update() & ParameterSnapshot::combChanged))
+            return;
+        
+        auto& settings = parameters.get();
         
         for (int harm = 0; harm < MAX_NUM_FILTERS; ++harm)
         {
-            freqBands[harm]->updateParams(settings.resonance, settings.timbre, settings.curve, settings.spread, CombProcessor::FreqOutOfBoundsMode::Ignore);
+            freqBands[harm]->setVisible(harm < settings.harmonics);
+            
+            if (harm < settings.harmonics)
+                freqBands[harm]->updateParams(settings.resonance, settings.timbre, settings.curve, settings.spread, CombProcessor::FreqOutOfBoundsMode::Ignore);
         }
     }
 
@@ -186,6 +192,7 @@ private:
     std::array<std::unique_ptr<FreqBand>, MAX_NUM_FILTERS> freqBands;
     
     FineToothMIDIAudioProcessor& audioProcessor;
+    ParameterSnapshot parameters;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterDisplay)
 };
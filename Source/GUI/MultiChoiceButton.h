@@ -18,7 +18,7 @@ public:
             button.setClickingTogglesState (true);
         }
         
-        auto settings = getChainSettings(audioProcessor.apvts);
+        auto settings = audioProcessor.getParameterSnapshot().load();
         
         buttons[0].setConnectedEdges (Button::ConnectedOnRight);
         buttons[1].setConnectedEdges (3);
@@ -64,7 +64,6 @@ public:
         
         if (buttonState)
         {
-            auto settings = getChainSettings(audioProcessor.apvts);
             switch (i)
             {
                 case 0:
@@ -86,7 +85,9 @@ public:
                     break;
             }
             
-            settings.aliasMode = i;
+            // through the parameter, which the audio thread reads on its next block
+            if (auto* aliasMode = dynamic_cast<AudioParameterChoice*>(audioProcessor.apvts.getParameter("Alias Mode")))
+                *aliasMode = i;
         }
     }
 
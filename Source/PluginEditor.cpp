@@ -59,7 +59,7 @@ FineToothMIDIAudioProcessorEditor::FineToothMIDIAudioProcessorEditor (FineToothM
     sourceButtons[1].setLookAndFeel(&customLNF);
 
     // Set the initial value.
-    auto settings = getChainSettings(audioProcessor.apvts);
+    auto settings = audioProcessor.getParameterSnapshot().load();
     sourceButtons[0].setToggleState (! settings.inputMode, dontSendNotification);
 
     sourceButtons[0].onClick = [this] { inputButtonClicked(0); };
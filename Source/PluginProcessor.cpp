@@ -7,7 +7,9 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! FINETOOTH_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
 //==============================================================================
 FineToothMIDIAudioProcessor::FineToothMIDIAudioProcessor()
@@ -25,10 +27,8 @@ FineToothMIDIAudioProcessor::FineToothMIDIAudioProcessor()
                        ), apvts(*this, nullptr, "PARAMETERS", createParameterLayout())
 #endif
 {
+    // the voices are allocated in prepareToPlay, as many as Polyphony can use
     synth.addSound(new SynthSound());
-    
-    for (int i = 0; i < NUM_VOICES; ++i)
-        synth.addVoice(new SynthVoice());
 }
 
 FineToothMIDIAudioProcessor::~FineToothMIDIAudioProcessor()
@@ -66,7 +66,16 @@ bool FineToothMIDIAudioProcessor::isMidiEffect() const
 
 double FineToothMIDIAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // the output comes the latency late, the tail with it
+    auto sampleRate = getSampleRate();
+    auto latencySeconds = sampleRate > 0.0 ? getLatencySamples() / sampleRate : 0.0;
+    
+    return tailSeconds.load() + latencySeconds;
+}
+
+void FineToothMIDIAudioProcessor::audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup)
+{
+    synth.setAudioWorkgroup (workgroup);
 }
 
 int FineToothMIDIAudioProcessor::getNumPrograms()
@@ -100,9 +109,17 @@ void FineToothMIDIAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     
     for (int i = 0; i < synth.getNumVoices(); ++i)
         if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-            voice->prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
-        
+            prepareVoice(*voice, sampleRate, samplesPerBlock);
+    
+    prepareVoicePool(sampleRate, samplesPerBlock);
+    splittingAutomation = automationSplitting;
+    
+    // whatever was queued while the audio thread wasn't running, rather
+    // than leaving it for the first block
+    handleCommands();
+    
     noiseBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    noise.prepare(sampleRate);
     
     /*
     // initialize comb processor
@@ -133,6 +150,36 @@ void FineToothMIDIAudioProcessor::prepareToPlay (double sampleRate, int samplesP
      */
 }
 
+void FineToothMIDIAudioProcessor::prepareVoice(SynthVoice& voice, double sampleRate, int samplesPerBlock)
+{
+    // the batches run every lane at the host rate
+    voice.getCombProcessor().setMultirate(! voiceBatching);
+    voice.prepareToPlay(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+}
+
+void FineToothMIDIAudioProcessor::prepareVoicePool(double sampleRate, int samplesPerBlock)
+{
+    synth.releaseBatchLanes();
+    
+    // enough for the highest Polyphony, so changing it never allocates
+    while (synth.getNumVoices() < POLYPHONY_MAX + NUM_STEAL_VOICES)
+    {
+        auto voice = new SynthVoice();
+        prepareVoice(*voice, sampleRate, samplesPerBlock);
+        synth.addVoice(voice);
+    }
+    
+    // the comb's subband filters delay the output
+    if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(0)))
+        setLatencySamples(voice->getCombProcessor().getLatency());
+    
+    synth.prepare(numRenderThreads, voiceBatching, samplesPerBlock);
+    
+    // new and prepared voices get every setting, not just what changed
+    parameters.invalidate();
+    setVoiceParams();
+}
+
 void FineToothMIDIAudioProcessor::releaseResources()
 {
     for (int i = 0; i < synth.getNumVoices(); ++i)
@@ -142,6 +189,8 @@ void FineToothMIDIAudioProcessor::releaseResources()
             voice->reset();
         }
     }
+    
+    synth.releaseResources();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -176,18 +225,36 @@ void FineToothMIDIAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
+    handleCommands();
     setVoiceParams();
     
+    // once its input stops, a held note rings on until its comb has decayed
+    // and a released one for no longer than its release. Between notes the
+    // last ones played stand in for the next
+    if (synth.isPlaying())
+        ringSeconds = synth.getRingTime(-SILENCE_THRESHOLD_DB);
+    
+    tailSeconds = jmax(releaseSeconds, ringSeconds);
+    
+    // every voice has died away and no note is coming, so the block is
+    // silent without running the noise or the synth
+    if (! synth.isPlaying() && midiMessages.isEmpty())
+    {
+        buffer.clear();
+        return;
+    }
+    
     if (! inputMode)
     {
-        noiseBuffer.clear();
-        for (int ch = 0; ch < getTotalNumOutputChannels(); ++ch)
-            for (int s = 0; s < numSamples; ++s)
-                noiseBuffer.setSample(ch, s, random.nextFloat() * 0.5f);
+        // the same stretch of the timeline always gets the same noise
+        if (synth.isDeterministic())
+            if (auto position = getTimelinePosition())
+                noise.setPosition(uint64(*position));
+        
+        noise.process(noiseBuffer.getArrayOfWritePointers(), getTotalNumOutputChannels(), numSamples);
     }
     else
     {
-        noiseBuffer.clear();
         auto noiseBufferPtr = noiseBuffer.getArrayOfWritePointers();
         auto bufferPtr = buffer.getArrayOfReadPointers();
         for (int ch = 0; ch < getTotalNumOutputChannels(); ++ch)
@@ -196,87 +263,184 @@ void FineToothMIDIAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
         }
     }
     
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-        {
-            voice->fillBuffer(noiseBuffer, numSamples);
-        }
-    }
-    
     buffer.clear();
     
+    synth.setExcitation(noiseBuffer);
+    
+    // the host only hands over each parameter's value at the end of the
+    // block, so the combs ramp there from the last block's values
+    if (splittingAutomation)
+        synth.setCombRamp(getCombParams(parameters.getLast()), getCombParams(parameters.get()), numSamples);
+    
     synth.renderNextBlock(buffer, midiMessages, 0, numSamples);
 }
 
 void FineToothMIDIAudioProcessor::setVoiceParams()
 {
-    auto settings = getChainSettings(apvts);
+    // nothing is passed on unless it changed since the last block
+    auto changes = parameters.update();
+    auto& settings = parameters.get();
     
-    inputMode = settings.inputMode;
+    if (changes & ParameterSnapshot::globalChanged)
+    {
+        inputMode = settings.inputMode;
+        noise.setColour(NoiseGenerator::Colour(settings.noiseColour));
+        noise.setStream(settings.deterministic ? 0 : noiseStream);
+        synth.setDeterministic(settings.deterministic);
+        
+        // every voice is already prepared, those past a smaller pool fade out
+        synth.setPolyphony(settings.polyphony);
+        synth.setNumVoicesInUse(settings.polyphony + NUM_STEAL_VOICES);
+    }
     
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    if (changes & ParameterSnapshot::combChanged)
     {
-        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
-        {
-            auto& comb = voice->getCombProcessor();
-            auto& adsr = voice->getADSR();
+        auto combParams = getCombParams(settings);
+        
+        // idle voices too, so their next note starts on the new settings
+        for (auto* voice : synth.getSynthVoices())
+            voice->getCombProcessor().updateParams(combParams);
+    }
+    
+    if (changes & ParameterSnapshot::envelopeChanged)
+    {
+        releaseSeconds = settings.release / 1000.0f;
+        
+        // a sounding note follows the new settings from where it is
+        Envelope::Parameters envelopeParams(settings.attack / 1000.0f, settings.decay / 1000.0f, settings.sustain, settings.release / 1000.0f,
+                                            Envelope::Shape(settings.envelopeShape));
+        
+        for (auto* voice : synth.getSynthVoices())
+            voice->getEnvelope().setParameters(envelopeParams);
+    }
+}
+
+CombProcessor::Parameters FineToothMIDIAudioProcessor::getCombParams(const ChainSettings& settings)
+{
+    CombProcessor::FreqOutOfBoundsMode mode;
+    switch (settings.aliasMode)
+    {
+        case 0:
+            mode = CombProcessor::FreqOutOfBoundsMode::Ignore;
+            break;
             
-            CombProcessor::FreqOutOfBoundsMode mode;
-            switch (settings.aliasMode)
-            {
-                case 0:
-                    mode = CombProcessor::FreqOutOfBoundsMode::Ignore;
-                    break;
-                    
-                case 1:
-                    mode = CombProcessor::FreqOutOfBoundsMode::Wrap;
-                    break;
-                    
-                case 2:
-                    mode = CombProcessor::FreqOutOfBoundsMode::Fold;
-                    break;
-                    
-                default:
-                    mode = CombProcessor::FreqOutOfBoundsMode::Ignore;
-                    break;
-            }
+        case 1:
+            mode = CombProcessor::FreqOutOfBoundsMode::Wrap;
+            break;
             
-            comb.updateParams(CombProcessor::Parameters(-1.0f, settings.resonance, settings.timbre, settings.curve, settings.spread, settings.glide, mode));
+        case 2:
+            mode = CombProcessor::FreqOutOfBoundsMode::Fold;
+            break;
             
-            if (! adsr.isActive())
-                adsr.setParameters(ADSR::Parameters(settings.attack / 1000.0f, settings.decay / 1000.0f, settings.sustain, settings.release / 1000.0f));
-        }
+        default:
+            mode = CombProcessor::FreqOutOfBoundsMode::Ignore;
+            break;
     }
+    
+    CombProcessor::Engine engine;
+    switch (settings.engine)
+    {
+        case 1:
+            engine = CombProcessor::Engine::Modal;
+            break;
+            
+        case 2:
+            engine = CombProcessor::Engine::Waveguide;
+            break;
+            
+        default:
+            engine = CombProcessor::Engine::SVF;
+            break;
+    }
+    
+    return CombProcessor::Parameters(-1.0f, settings.resonance, settings.timbre, settings.curve, settings.spread, settings.glide, mode, settings.harmonics, engine);
+}
+
+Optional<int64> FineToothMIDIAudioProcessor::getTimelinePosition()
+{
+    auto* playHead = getPlayHead();
+    if (playHead == nullptr)
+        return {};
+    
+    // a stopped host may report the same position every block, which would
+    // repeat one block of noise, so the noise runs on by itself then
+    auto position = playHead->getPosition();
+    if (! position.hasValue() || ! position->getIsPlaying())
+        return {};
+    
+    if (auto samples = position->getTimeInSamples())
+        return *samples;
+    
+    auto ppq = position->getPpqPosition();
+    auto bpm = position->getBpm();
+    if (ppq.hasValue() && bpm.hasValue() && *bpm > 0.0)
+        return roundToInt64(*ppq * 60.0 / *bpm * getSampleRate());
+    
+    return {};
 }
 
 void FineToothMIDIAudioProcessor::panic()
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    // the voices belong to the audio thread, so they stop at the top of its next block
+    commands.push({ CommandQueue::Command::Type::Panic });
+}
+
+void FineToothMIDIAudioProcessor::allNotesOff()
+{
+    commands.push({ CommandQueue::Command::Type::AllNotesOff });
+}
+
+void FineToothMIDIAudioProcessor::handleCommands()
+{
+    CommandQueue::Command command;
+    
+    while (commands.pop(command))
     {
-        if (auto voice = dynamic_cast<SynthVoice*>(synth.getVoice(i)))
+        switch (command.type)
         {
-            auto& adsr = voice->getADSR();
-            
-            adsr.reset();
+            case CommandQueue::Command::Type::Panic:
+                synth.stopAllVoices();
+                break;
+                
+            case CommandQueue::Command::Type::AllNotesOff:
+                synth.allNotesOff(0, true);
+                break;
+                
+            case CommandQueue::Command::Type::StateRestored:
+                parameters.invalidate();
+                break;
+                
+            default:
+                break;
         }
     }
 }
 
 void FineToothMIDIAudioProcessor::setInputMode(int state)
 {
-    apvts.getParameter("Input Mode")->setValue(state);
+    // a parameter, so the host hears about it and the audio thread reads it
+    // through the snapshot
+    apvts.getParameter("Input Mode")->setValueNotifyingHost(float(state));
 }
 
 //==============================================================================
 bool FineToothMIDIAudioProcessor::hasEditor() const
 {
+    // the command line renderer is built without the GUI sources
+   #if FINETOOTH_HEADLESS
+    return false;
+   #else
     return true; // (change this to false if you choose to not supply an editor)
+   #endif
 }
 
 juce::AudioProcessorEditor* FineToothMIDIAudioProcessor::createEditor()
 {
+   #if FINETOOTH_HEADLESS
+    return nullptr;
+   #else
     return new FineToothMIDIAudioProcessorEditor (*this);
+   #endif
 //    return new GenericAudioProcessorEditor (*this);
 }
 
@@ -292,8 +456,9 @@ void FineToothMIDIAudioProcessor::setStateInformation (const void* data, int siz
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
         if ( tree.isValid() )
         {
+            // the next block applies every parameter again
             apvts.replaceState(tree);
-            setVoiceParams();
+            commands.push({ CommandQueue::Command::Type::StateRestored });
         }
 }
 
@@ -12,6 +12,9 @@
 #include "params.h"
 #include "config.h"
 #include "audio/CombProcessor.h"
+#include "audio/NoiseGenerator.h"
+#include "synth/CommandQueue.h"
+#include "synth/Synth.h"
 #include "synth/SynthVoice.h"
 #include "synth/SynthSound.h"
 
@@ -51,6 +54,8 @@ public:
     bool producesMidi() const override;
     bool isMidiEffect() const override;
     double getTailLengthSeconds() const override;
+    // the render threads join the workgroup from the next prepareToPlay
+    void audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup) override;
 
     //==============================================================================
     int getNumPrograms() override;
@@ -63,11 +68,24 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    // both queue a command for the audio thread, from the message thread only,
+    // or from the thread calling processBlock() when rendering offline
     void panic();
+    void allNotesOff();
     void setInputMode (int state);
+    // worker threads rendering voices next to the audio thread, applied on the next prepareToPlay
+    void setNumRenderThreads (int numThreads) { numRenderThreads = numThreads; }
+    // CombBatch lanes instead of per-voice multirate combs, applied on the next prepareToPlay
+    void setVoiceBatching (bool shouldBatch) { voiceBatching = shouldBatch; }
+    // ramp automated comb parameters across each block, see Synth::setCombRamp(), applied on the next prepareToPlay
+    void setAutomationSplitting (bool shouldSplit) { automationSplitting = shouldSplit; }
     
     APVTS apvts;
     
+    // for reading every parameter off the audio thread, through handles
+    // looked up once
+    const ParameterSnapshot& getParameterSnapshot() const { return parameters; }
+    
 //    std::array<ADSR, NUM_VOICES> adsr;
 //    std::array<std::unique_ptr<CombProcessor>, NUM_VOICES> processor;
 
@@ -75,10 +93,34 @@ private:
 //    void updateAll ();
 //    void updateVoice (int voice);
 //    void updateFilter ();
+    // passes the parameters that changed since the last call on to the
+    // noise, the synth and every voice
     void setVoiceParams ();
-    Random random;
+    // carries out the commands queued since the last block
+    void handleCommands();
+    static CombProcessor::Parameters getCombParams (const ChainSettings& settings);
+    void prepareVoice (SynthVoice& voice, double sampleRate, int samplesPerBlock);
+    // POLYPHONY_MAX + NUM_STEAL_VOICES voices, never called on the audio thread
+    void prepareVoicePool (double sampleRate, int samplesPerBlock);
+    // the host's timeline position in samples, only while it's playing
+    Optional<int64> getTimelinePosition();
+    // the longer of the release and the ring time of the last notes played,
+    // for getTailLengthSeconds() off the audio thread
+    std::atomic<double> tailSeconds { 0.0 };
+    float releaseSeconds = 0.0f, ringSeconds = 0.0f;
+    // the audio thread's, setVoiceParams() is the only caller of update()
+    ParameterSnapshot parameters { apvts };
+    // from the message thread to the audio thread
+    CommandQueue commands;
+    NoiseGenerator noise;
+    // each instance plays its own noise, unless Deterministic is on
+    const uint32 noiseStream = uint32(Random::getSystemRandom().nextInt());
     
-    Synthesiser synth;
+    Synth synth;
+    int numRenderThreads = RENDER_THREADS;
+    bool voiceBatching = VOICE_BATCHING;
+    // what setAutomationSplitting() asked for, and what processBlock does
+    bool automationSplitting = AUTOMATION_SPLITTING, splittingAutomation = AUTOMATION_SPLITTING;
     
     AudioBuffer<float> noiseBuffer;
     
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    CombBatch.cpp
+    Created: 17 Oct 2026 12:07:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "CombBatch.h"
+
+namespace audio
+{
+
+void CombBatch::prepare(double sampleRate, int maxBlockSize, int numSlotsPerLane)
+{
+    // the combs detach themselves when they are prepared
+    combs.fill(nullptr);
+    
+    svfBank.prepare(sampleRate, numSlotsPerLane * numLanes);
+    modalBank.prepare(sampleRate, numSlotsPerLane * numLanes);
+    
+    for (auto* outputs : { &laneOutputs, &fadingOutputs })
+        for (auto& output : *outputs)
+            output.assign(maxBlockSize, ResonatorBank::Vec::expand(0.0f));
+    
+    fadingBank = nullptr;
+}
+
+void CombBatch::reset()
+{
+    svfBank.reset();
+    modalBank.reset();
+    fadingBank = nullptr;
+}
+
+void CombBatch::setCullThreshold(float thresholdDb)
+{
+    svfBank.setCullThreshold(thresholdDb);
+    modalBank.setCullThreshold(thresholdDb);
+}
+
+void CombBatch::setLane(int lane, CombProcessor* comb)
+{
+    if (combs[lane] == comb)
+        return;
+    
+    if (combs[lane] != nullptr)
+        combs[lane]->detachFromBatch();
+    
+    combs[lane] = comb;
+    
+    if (comb != nullptr)
+        comb->attachToBatch(&svfBank, &modalBank, lane);
+}
+
+bool CombBatch::isEmpty() const
+{
+    for (auto* comb : combs)
+        if (comb != nullptr)
+            return false;
+    
+    return true;
+}
+
+void CombBatch::process(const float* const* input, int numChannels, int numSamples)
+{
+    jassert(numChannels <= maxChannels && numSamples <= int(laneOutputs[0].size()));
+    
+    // every voice has the same settings, so the first lane speaks for all
+    auto controlInterval = CONTROL_INTERVAL;
+    
+    for (auto* comb : combs)
+    {
+        if (comb == nullptr)
+            continue;
+        
+        jassert(comb->getEngine() != CombProcessor::Engine::Waveguide);
+        
+        // the lanes pushed all their tables to the new bank when they
+        // switched, and fade out of the old one, which keeps ringing
+        if (comb->getEngine() != engine)
+        {
+            fadingBank = bank;
+            engine = comb->getEngine();
+            bank = engine == CombProcessor::Engine::Modal ? static_cast<ResonatorBank*> (&modalBank) : &svfBank;
+            bank->reset();
+        }
+        
+        controlInterval = comb->getControlInterval();
+        break;
+    }
+    
+    for (int pos = 0; pos < numSamples; pos += controlInterval)
+    {
+        auto numControlSamples = jmin(controlInterval, numSamples - pos);
+        
+        for (auto* comb : combs)
+            if (comb != nullptr)
+                comb->advanceControl(numControlSamples);
+        
+        const float* in[maxChannels];
+        float* out[maxChannels];
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            in[ch] = input[ch] + pos;
+            out[ch] = reinterpret_cast<float*> (laneOutputs[ch].data() + pos);
+        }
+        
+        if (fadingBank == nullptr)
+        {
+            bank->processLanes(in, out, numChannels, numControlSamples);
+            continue;
+        }
+        
+        float* fading[maxChannels];
+        for (int ch = 0; ch < numChannels; ++ch)
+            fading[ch] = reinterpret_cast<float*> (fadingOutputs[ch].data());
+        
+        fadingBank->processLanes(in, fading, numChannels, numControlSamples);
+        bank->processLanes(in, out, numChannels, numControlSamples);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < numControlSamples; ++s)
+                laneOutputs[ch][size_t(pos + s)] += fadingOutputs[ch][size_t(s)];
+        
+        // every lane has faded out, so the old bank has culled all its groups
+        if (fadingBank->getNumActiveSlots() == 0)
+            fadingBank = nullptr;
+    }
+}
+
+void CombBatch::copyLaneOutput(int lane, float* const* output, int numChannels, int numSamples) const
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* laneSamples = reinterpret_cast<const float*> (laneOutputs[ch].data()) + lane;
+        
+        for (int s = 0; s < numSamples; ++s)
+            output[ch][s] = laneSamples[s * numLanes];
+    }
+}
+
+}
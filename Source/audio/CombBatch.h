@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    CombBatch.h
+    Created: 17 Oct 2026 12:07:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef COMBBATCH_H
+#define COMBBATCH_H
+
+#include <JuceHeader.h>
+#include "CombProcessor.h"
+
+namespace audio
+{
+
+/*
+    Runs up to laneWidth voices through one pair of resonator banks, one
+    voice to each SIMD lane.
+
+    In the per-voice path a register holds laneWidth harmonics of one voice,
+    and the lanes are summed horizontally every sample. Here group g holds
+    bank slot g of every voice, so one register step advances laneWidth
+    voices. Harmonic counts that don't fill a group leave no lanes empty,
+    and lanes are never summed. Each voice's CombProcessor still smooths
+    its parameters and computes its own coefficients and gains. It writes
+    them into its lane (see CombProcessor::attachToBatch()), so a voice
+    sounds as it does in the per-voice path without multirate. Every lane
+    filters the same input, the excitation shared by all voices.
+
+    A group is only culled once all its lanes are silent. Lanes whose voice
+    is taken away fade out over one control interval. All lanes follow the
+    engine of the voices, and the waveguide has no bank to batch. When the
+    engine changes, the old bank runs on next to the new one while the
+    voices crossfade their lanes from one to the other, until every lane
+    has faded out of it.
+*/
+class CombBatch
+{
+public:
+    static constexpr int numLanes = ResonatorBank::laneWidth;
+    static constexpr int maxChannels = ResonatorBank::maxChannels;
+    
+    CombBatch() {;}
+    ~CombBatch() {;}
+    
+    // numSlotsPerLane from CombProcessor::getNumSlots()
+    void prepare(double sampleRate, int maxBlockSize, int numSlotsPerLane);
+    void reset();
+    void setCullThreshold(float thresholdDb);
+    // gives the lane to comb, prepared at this rate without multirate, or
+    // frees it with nullptr
+    void setLane(int lane, CombProcessor* comb);
+    CombProcessor* getLane(int lane) const { return combs[lane]; }
+    bool isEmpty() const;
+    // filters input through every lane, never with the waveguide engine
+    void process(const float* const* input, int numChannels, int numSamples);
+    // the lane's output from the last process()
+    void copyLaneOutput(int lane, float* const* output, int numChannels, int numSamples) const;
+
+private:
+    FilterBank svfBank;
+    ModalBank modalBank;
+    ResonatorBank* bank = &svfBank;
+    // the last engine's bank, while lanes are still fading out of it
+    ResonatorBank* fadingBank = nullptr;
+    CombProcessor::Engine engine = CombProcessor::Engine::SVF;
+    
+    std::array<CombProcessor*, numLanes> combs {};
+    // one register per sample, lane by lane
+    std::array<std::vector<ResonatorBank::Vec>, maxChannels> laneOutputs, fadingOutputs;
+};
+
+}
+
+#endif // COMBBATCH_H
@@ -16,110 +16,338 @@ namespace audio
 CombProcessor::CombProcessor(unsigned int _maxNumFilters) :
     curParams(A440, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_DEFAULT),
     maxNumFilters(_maxNumFilters),
-    numFilters(_maxNumFilters)
+    numFilters(jmin(HARMONICS_DEFAULT, int(_maxNumFilters)))
 {
     freq.setCurrentAndTargetValue(A440);
     q.setCurrentAndTargetValue(RESONANCE_DEFAULT);
     timbre.setCurrentAndTargetValue(TIMBRE_DEFAULT);
     curve.setCurrentAndTargetValue(CURVE_DEFAULT);
     spread.setCurrentAndTargetValue(SPREAD_DEFAULT);
+    
+    for (int level = 0; level < SubbandProcessor::maxLevels; ++level)
+        banks[level] = getBank(engine, level);
 }
 
 void CombProcessor::prepare(const dsp::ProcessSpec& spec)
 {
+    sampleRate = spec.sampleRate;
+    
+    // even harmonic indices fill the first SIMD groups, odd ones start on the
+    // next group boundary
+    auto laneWidth = ResonatorBank::laneWidth;
+    oddSlotOffset = (int(maxNumFilters + 1) / 2 + laneWidth - 1) / laneWidth * laneWidth;
+    
+    auto numSlots = oddSlotOffset + int(maxNumFilters) / 2;
+    
+    // halve the rate for each level down to MULTIRATE_MIN_RATE. At lower
+    // host rates most partials are near the top anyway, so they'd save
+    // little for the latency
+    int numLevels = 1;
+    while (multirate && sampleRate >= MULTIRATE_MIN_HOST_RATE && numLevels < SubbandProcessor::maxLevels && sampleRate / double(1 << numLevels) >= MULTIRATE_MIN_RATE)
+        ++numLevels;
+    
+    subbands.prepare(sampleRate, int(spec.maximumBlockSize), numLevels);
+    
+    svfBatchBank = nullptr;
+    modalBatchBank = nullptr;
+    batchLane = -1;
+    slotStride = 1;
+    slotOffset = 0;
+    
+    for (int level = 0; level < numLevels; ++level)
+    {
+        for (auto* engineBank : { getBank(Engine::SVF, level), getBank(Engine::Modal, level) })
+            engineBank->prepare(subbands.getLevelRate(level), numSlots);
+        
+        banks[level] = getBank(engine == Engine::Modal ? Engine::Modal : Engine::SVF, level);
+    }
+    
+    waveguide.prepare(spec);
+    
+    for (auto& channel : waveguideOutput)
+        channel.assign(spec.maximumBlockSize, 0.0f);
+    
     for (int ch = 0; ch < numChannels; ++ch)
     {
-        for (int i = 0; i < maxNumFilters; ++i)
-        {
-            chain[ch][i].prepare(spec);
-            chain[ch][i].get<ChainPositions::Filter>().setType(dsp::StateVariableTPTFilterType::bandpass);
-        }
+        waveguideDelay[ch].assign(subbands.getLatency(), 0.0f);
+        waveguideInput[ch].assign(spec.maximumBlockSize, 0.0f);
     }
     
-    sampleRate = spec.sampleRate;
-    tempBuffer.setSize(numChannels, spec.maximumBlockSize);
-    outBuffer.setSize(numChannels, spec.maximumBlockSize);
+    fadeLength = jmax(1, roundToInt(ENGINE_FADE_MS * 0.001 * sampleRate));
+    endFade();
+    
+    for (auto* table : { &log2Harmonics, &log2QSteps, &ratios, &harmFreqs, &harmQs, &qGains, &timbreGains, &curveGains })
+        table->assign(maxNumFilters, 0.0f);
+    
+    for (auto* table : { &slotFreqs, &slotQs, &slotGains, &fadeGains })
+        table->assign(numSlots, 0.0f);
+    
+    harmLevels.assign(maxNumFilters, 0);
+    levelQScales.assign(maxNumFilters, 1.0f);
+    
+    // exponents for the ratio and Q compensation tables, fixed per harmonic
+    for (int i = 0; i < int(maxNumFilters); ++i)
+    {
+        log2Harmonics[i] = std::log2(float(i + 1));
+        log2QSteps[i] = std::log2(float(i) / 2.f + 1);
+    }
     
     freq.reset(sampleRate, glide);
     q.reset(sampleRate, SMOOTH_SEC);
     timbre.reset(sampleRate, SMOOTH_SEC);
     curve.reset(sampleRate, SMOOTH_SEC);
     spread.reset(sampleRate, SMOOTH_SEC);
+    
+    numBankHarmonics = 0;
+    cacheValid = false;
 }
 
 void CombProcessor::reset()
 {
-    for (int ch = 0; ch < numChannels; ++ch)
-        for (int i = 0; i < maxNumFilters; ++i)
-            chain[ch][i].reset();
+    // the batch's banks ring on in the other voices' lanes, so only this
+    // one's is cleared
+    if (isAttachedToBatch())
+    {
+        svfBatchBank->clearSlots(getNumSlots(), slotOffset, slotStride);
+        modalBatchBank->clearSlots(getNumSlots(), slotOffset, slotStride);
+    }
+    else
+    {
+        for (int level = 0; level < subbands.getNumLevels(); ++level)
+            banks[level]->reset();
+    }
+    
+    subbands.reset();
+    waveguide.reset();
+    endFade();
+    
+    for (auto& channel : waveguideDelay)
+        std::fill(channel.begin(), channel.end(), 0.0f);
     
+    waveguideDelayPos = 0;
 }
 
-void CombProcessor::process(AudioBuffer<float> &buffer, int numSamples, int startSample)
+void CombProcessor::restart()
 {
-    auto inWrite = buffer.getArrayOfWritePointers();
-    auto tempWrite = tempBuffer.getArrayOfWritePointers();
-    auto outWrite = outBuffer.getArrayOfWritePointers();
+    reset();
     
-    float curFreq = freq.getNextValue();
-    float curQ = q.getNextValue();
-    float curTimbre = timbre.getNextValue();
-    float curCurve = curve.getNextValue();
-    float curSpread = spread.getNextValue();
+    for (auto* value : { &freq, &q, &spread })
+        value->setCurrentAndTargetValue(value->getTargetValue());
     
-    DBG(curFreq);
+    for (auto* value : { &timbre, &curve })
+        value->setCurrentAndTargetValue(value->getTargetValue());
     
-    updateParamsObject(curFreq, curQ, curTimbre, curCurve, curSpread);
+    // the subband levels are picked again from the top, and every table is
+    // rebuilt and pushed to the banks
+    std::fill(harmLevels.begin(), harmLevels.end(), 0);
+    numBankHarmonics = int(maxNumFilters);
+    cacheValid = false;
+}
+
+void CombProcessor::process(const AudioBuffer<float> &input, AudioBuffer<float> &output, int numSamples, int startSample)
+{
+    jassert(! isAttachedToBatch());
     
-    // clear output buffer
+    const float* inputs[numChannels];
+    float* channels[numChannels];
     for (int ch = 0; ch < numChannels; ++ch)
     {
-        SIMD::fill(outWrite[ch], 0.0f, numSamples);
+        inputs[ch] = input.getReadPointer(ch, startSample);
+        channels[ch] = output.getWritePointer(ch, startSample);
     }
     
-    // process bandpass filter for each harmonic
-    for (int i = 0; i < numFilters; ++i)
+    numCoefficientUpdates = 0;
+    cacheStats = {};
+    
+    // advance params once per control interval, the bank ramps its
+    // coefficients linearly across each interval
+    for (int pos = 0; pos < numSamples; pos += controlInterval)
     {
-        // update processors
-        if (! updateFilterSettings(curFreq, curQ, curSpread, i))
+        auto numControlSamples = jmin(controlInterval, numSamples - pos);
+        
+        advanceParams(numControlSamples);
+        
+        auto fading = isFadingEngine();
+        auto fadeFrom = 1.0f, fadeTo = 1.0f;
+        advanceFade(numControlSamples, fadeFrom, fadeTo);
+        
+        // both engines run while one fades into the other
+        auto runWaveguide = engine == Engine::Waveguide || (fading && fadingEngine == Engine::Waveguide);
+        auto runBanks = engine != Engine::Waveguide || fading;
+        
+        if (runWaveguide)
         {
-            break;
+            // into a buffer of its own when the banks run too, as they may
+            // overwrite the input
+            float* waveguideChannels[numChannels];
+            for (int ch = 0; ch < numChannels; ++ch)
+                waveguideChannels[ch] = runBanks ? waveguideOutput[ch].data() : channels[ch];
+            
+            // late by as much as the subbands make the banks
+            const float* waveguideInputs[numChannels];
+            delayWaveguideInput(inputs, waveguideInputs, numControlSamples);
+            
+            waveguide.setParameters(curParams.freq, curParams.resonance, curParams.timbre, curParams.curve);
+            waveguide.process(waveguideInputs, waveguideChannels, numChannels, numControlSamples);
+            
+            if (fading)
+            {
+                // a straight line across the interval, as the banks' gains ramp
+                auto from = engine == Engine::Waveguide ? fadeFrom : 1.0f - fadeFrom;
+                auto step = ((engine == Engine::Waveguide ? fadeTo : 1.0f - fadeTo) - from) / float(numControlSamples);
+                
+                for (int ch = 0; ch < numChannels; ++ch)
+                    for (int s = 0; s < numControlSamples; ++s)
+                        waveguideChannels[ch][s] *= from + step * float(s + 1);
+            }
         }
         
-        updateTimbre(curTimbre, i);
-        updateCurve(curCurve, curQ, i);
-            
-        // copy contents of input buffer to temp buffer
-        tempBuffer.clear();
-        for (int ch = 0; ch < numChannels; ++ch)
+        if (runBanks)
         {
-            auto inWritePtr = buffer.getReadPointer(ch, startSample);
-            SIMD::copy(tempWrite[ch], inWritePtr, numSamples);
+            updateHarmonics(curParams.freq, curParams.resonance, curParams.timbre, curParams.curve, curParams.spread);
+            
+            // filter, weight and sum all harmonics, of both bank engines
+            // while they crossfade
+            auto fadeBanks = fading && engine != Engine::Waveguide && fadingEngine != Engine::Waveguide;
+            subbands.process(banks.data(), fadeBanks ? fadingBanks.data() : nullptr, inputs, channels, numChannels, numControlSamples);
+            
+            if (runWaveguide)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    SIMD::add(channels[ch], waveguideOutput[ch].data(), numControlSamples);
         }
         
-        // process the temp buffer and add it to output buffer
-        dsp::AudioBlock<float> block(tempBuffer);
+        // the loop loses 2 pi / resonance nepers per period, the fundamental
+        // least of all
+        if (engine == Engine::Waveguide)
+            ringTimeConstant = curParams.resonance / (Tau * jmax(curParams.freq, 1.0f));
+        
         for (int ch = 0; ch < numChannels; ++ch)
         {
-            auto channelBlock = block.getSingleChannelBlock(ch);
-            dsp::ProcessContextReplacing<float> context(channelBlock);
-            chain[ch][i].process(context);
-            
-            // add to output buffer
-            SIMD::add(outWrite[ch], tempWrite[ch], numSamples);
+            inputs[ch] += numControlSamples;
+            channels[ch] += numControlSamples;
         }
     }
-     
-    // write contents of output buffer to input buffer
+}
+
+void CombProcessor::advanceControl(int numControlSamples)
+{
+    // the batch only runs resonator banks
+    jassert(isAttachedToBatch() && engine != Engine::Waveguide);
+    
+    numCoefficientUpdates = 0;
+    cacheStats = {};
+    
+    advanceParams(numControlSamples);
+    
+    auto fadeFrom = 1.0f, fadeTo = 1.0f;
+    advanceFade(numControlSamples, fadeFrom, fadeTo);
+    
+    updateHarmonics(curParams.freq, curParams.resonance, curParams.timbre, curParams.curve, curParams.spread);
+}
+
+void CombProcessor::attachToBatch(FilterBank* svfBank, ModalBank* modalBank, int lane)
+{
+    // the batch's banks run at the host rate only
+    jassert(subbands.getNumLevels() == 1 && lane >= 0 && lane < ResonatorBank::laneWidth);
+    
+    svfBatchBank = svfBank;
+    modalBatchBank = modalBank;
+    batchLane = lane;
+    slotStride = ResonatorBank::laneWidth;
+    slotOffset = lane;
+    banks[0] = getProcessingBank(engine, 0);
+    endFade();
+    
+    // the lane may hold another voice's tables, so push all of them
+    numBankHarmonics = int(maxNumFilters);
+    cacheValid = false;
+}
+
+void CombProcessor::detachFromBatch()
+{
+    if (! isAttachedToBatch())
+        return;
+    
+    // fade the lane out in both banks, the batch keeps running its other lanes
+    std::fill(slotGains.begin(), slotGains.end(), 0.0f);
+    svfBatchBank->setGains(slotGains.data(), getNumSlots(), slotOffset, slotStride);
+    modalBatchBank->setGains(slotGains.data(), getNumSlots(), slotOffset, slotStride);
+    
+    svfBatchBank = nullptr;
+    modalBatchBank = nullptr;
+    batchLane = -1;
+    slotStride = 1;
+    slotOffset = 0;
+    banks[0] = getProcessingBank(engine, 0);
+    endFade();
+    
+    numBankHarmonics = int(maxNumFilters);
+    cacheValid = false;
+}
+
+void CombProcessor::advanceParams(int numControlSamples)
+{
+    curParams.freq = freq.skip(numControlSamples);
+    curParams.resonance = q.skip(numControlSamples);
+    curParams.timbre = timbre.skip(numControlSamples);
+    curParams.curve = curve.skip(numControlSamples);
+    curParams.spread = spread.skip(numControlSamples);
+    curParams.glide = glide;
+    curParams.mode = mode;
+    curParams.harmonics = numFilters;
+    curParams.engine = engine;
+}
+
+void CombProcessor::advanceFade(int numControlSamples, float& fadeFrom, float& fadeTo)
+{
+    fadeChanged = isFadingEngine();
+    
+    if (! fadeChanged)
+        return;
+    
+    fadeFrom = float(fadePosition) / float(fadeLength);
+    fadePosition = jmin(fadeLength, fadePosition + numControlSamples);
+    fadeTo = float(fadePosition) / float(fadeLength);
+    
+    // the banks fade out when the waveguide takes over from them
+    bankShare = engine == Engine::Waveguide ? 1.0f - fadeTo : fadeTo;
+}
+
+void CombProcessor::delayWaveguideInput(const float* const* input, const float** delayed, int numSamples)
+{
+    auto latency = getLatency();
+    int pos = waveguideDelayPos;
+    
     for (int ch = 0; ch < numChannels; ++ch)
-        SIMD::copy(inWrite[ch], outWrite[ch], numSamples);
+    {
+        if (latency == 0)
+        {
+            delayed[ch] = input[ch];
+            continue;
+        }
+        
+        auto* line = waveguideDelay[ch].data();
+        auto* out = waveguideInput[ch].data();
+        pos = waveguideDelayPos;
+        
+        for (int s = 0; s < numSamples; ++s)
+        {
+            out[s] = line[pos];
+            line[pos] = input[ch][s];
+            pos = pos + 1 == latency ? 0 : pos + 1;
+        }
+        
+        delayed[ch] = out;
+    }
     
-    // skip remaining samples for params
-    freq.skip(numSamples - 1);
-    q.skip(numSamples - 1);
-    timbre.skip(numSamples - 1);
-    curve.skip(numSamples - 1);
-    spread.skip(numSamples - 1);
+    waveguideDelayPos = pos;
+}
+
+void CombProcessor::endFade()
+{
+    fadePosition = fadeLength;
+    bankShare = 1.0f;
+    fadeChanged = false;
 }
 
 void CombProcessor::updateParams(Parameters params)
@@ -133,6 +361,8 @@ void CombProcessor::updateParams(Parameters params)
     spread.setTargetValue(params.spread);
     glide = params.glide;
     mode = params.mode;
+    setNumHarmonics(params.harmonics);
+    setEngine(params.engine);
     
     if (glide != lastGlide)
     {
@@ -141,11 +371,129 @@ void CombProcessor::updateParams(Parameters params)
     }
 }
 
+void CombProcessor::rampParams(Parameters params, int numSamples)
+{
+    // a new ramp length jumps a smoothed value to its target, so its
+    // target is moved to where it is first
+    for (auto* value : { &q, &spread })
+    {
+        value->setCurrentAndTargetValue(value->getCurrentValue());
+        value->reset(numSamples);
+    }
+    
+    for (auto* value : { &timbre, &curve })
+    {
+        value->setCurrentAndTargetValue(value->getCurrentValue());
+        value->reset(numSamples);
+    }
+    
+    updateParams(params);
+}
+
+void CombProcessor::setControlInterval(int numSamples)
+{
+    controlInterval = jmax(1, numSamples);
+}
+
+void CombProcessor::setCullThreshold(float thresholdDb)
+{
+    // a batch's banks take theirs from CombBatch::setCullThreshold()
+    for (int level = 0; level < SubbandProcessor::maxLevels; ++level)
+        for (auto* engineBank : { getBank(Engine::SVF, level), getBank(Engine::Modal, level) })
+            engineBank->setCullThreshold(thresholdDb);
+}
+
+void CombProcessor::setMultirate(bool enabled)
+{
+    multirate = enabled;
+}
+
+float CombProcessor::getRingTime(float decibels) const
+{
+    // decibels / 20 decades of amplitude
+    return ringTimeConstant * decibels / 20.0f * std::log(10.0f);
+}
+
+int CombProcessor::getNumActiveHarmonics() const
+{
+    if (engine == Engine::Waveguide)
+        return 0;
+    
+    int numActive = 0;
+    for (int level = 0; level < subbands.getNumLevels(); ++level)
+        numActive += banks[level]->getNumActiveSlots();
+    
+    return numActive;
+}
+
+void CombProcessor::setNumHarmonics(int numHarmonics)
+{
+    numHarmonics = jlimit(1, int(maxNumFilters), numHarmonics);
+    
+    if (numHarmonics != numFilters)
+    {
+        numFilters = numHarmonics;
+        cacheValid = false;
+    }
+}
+
+void CombProcessor::setEngine(Engine newEngine)
+{
+    if (newEngine == engine)
+        return;
+    
+    // the old engine keeps ringing and fades out while the new one, which
+    // starts silent, fades in, rather than being cut off
+    fadingEngine = engine;
+    fadePosition = 0;
+    engine = newEngine;
+    
+    if (engine == Engine::Waveguide)
+    {
+        waveguide.reset();
+        
+        // rather than what it heard the last time it played
+        for (auto& channel : waveguideDelay)
+            std::fill(channel.begin(), channel.end(), 0.0f);
+        
+        return;
+    }
+    
+    // the new banks start silent on the current settings, and any gains they
+    // kept from the last time they were active get cleared. A batch resets
+    // its banks itself once all its lanes have switched
+    for (int level = 0; level < subbands.getNumLevels(); ++level)
+    {
+        fadingBanks[level] = banks[level];
+        banks[level] = getProcessingBank(engine, level);
+        
+        if (! isAttachedToBatch())
+            banks[level]->reset();
+    }
+    
+    numBankHarmonics = int(maxNumFilters);
+    cacheValid = false;
+}
+
 CombProcessor::Parameters& CombProcessor::getParams()
 {
     return curParams;
 }
 
+CombProcessor::Parameters CombProcessor::getTargetParams() const
+{
+    auto params = curParams;
+    params.freq = freq.getTargetValue();
+    params.resonance = q.getTargetValue();
+    params.timbre = timbre.getTargetValue();
+    params.curve = curve.getTargetValue();
+    params.spread = spread.getTargetValue();
+    params.glide = glide;
+    params.mode = mode;
+    params.engine = engine;
+    return params;
+}
+
 void CombProcessor::setFrequency(float freq)
 {
     this->freq.setTargetValue(freq);
@@ -156,108 +504,311 @@ void CombProcessor::setCurveOffset(float offset)
     curve.setTargetValue(curParams.curve + offset);
 }
 
-void CombProcessor::updateParamsObject(float freq, float resonance, float timbre, float curve, float spread)
+
+void CombProcessor::updateHarmonics(float curFreq, float curQ, float curTimbre, float curCurve, float curSpread)
 {
-    curParams.freq = freq;
-    curParams.resonance = resonance;
-    curParams.timbre = timbre;
-    curParams.curve = curve;
-    curParams.spread = spread;
-    curParams.glide = glide;
-    curParams.mode = mode;
+    // only rebuild the tables whose inputs changed since the last update
+    bool spreadChanged = isDirty(cachedSpread, curSpread);
+    bool qChanged = isDirty(cachedQ, curQ);
+    bool timbreChanged = isDirty(cachedTimbre, curTimbre);
+    bool curveChanged = isDirty(cachedCurve, curCurve);
+    bool freqChanged = isDirty(cachedFreq, curFreq) || mode != cachedMode;
+    
+    cachedMode = mode;
+    cacheValid = true;
+    
+    if (spreadChanged)
+        updateRatios(curSpread);
+    
+    if (qChanged)
+        updateResonances(curQ);
+    
+    if (timbreChanged)
+        updateTimbre(curTimbre);
+    
+    if (curveChanged)
+        updateCurve(curCurve);
+    
+    int lastNumInRange = numInRange;
+    
+    if (freqChanged || spreadChanged || qChanged)
+        updateFilterSettings(curFreq);
+    
+    if (timbreChanged || curveChanged || qChanged || levelsChanged || fadeChanged || numInRange != lastNumInRange || numFilters != numBankHarmonics)
+        updateGains();
+    
+    auto countTable = [this] (bool recomputed) { recomputed ? ++cacheStats.recomputes : ++cacheStats.hits; };
+    countTable(spreadChanged);
+    countTable(qChanged);
+    countTable(timbreChanged);
+    countTable(curveChanged);
+    countTable(freqChanged || spreadChanged || qChanged);
 }
 
+bool CombProcessor::isDirty(float& cached, float value)
+{
+    if (cacheValid && cached == value)
+        return false;
+    
+    cached = value;
+    return true;
+}
 
+void CombProcessor::updateRatios(float curSpread)
+{
+    // (i + 1)^spread
+    for (int i = 0; i < numFilters; ++i)
+        ratios[i] = fastmath::exp2(curSpread * log2Harmonics[i]);
+}
 
-
-bool CombProcessor::updateFilterSettings(float curFreq, float curQ, float curSpread, int i)
+void CombProcessor::updateResonances(float curQ)
 {
-    float harmFreq, harmQ, nyquist = sampleRate / 2.0f;
+    float log2Q = fastmath::log2(curQ);
     
-    harmFreq = i ? curFreq * pow(float(i + 1), curSpread) : curFreq;
-    harmQ = curQ * (float(i) / 2.f + 1);
+    for (int i = 0; i < numFilters; ++i)
+    {
+        harmQs[i] = curQ * (float(i) / 2.f + 1);
+        
+        // compensate gain for tighter q values, (1 / harmQ)^0.6
+        qGains[i] = fastmath::exp2(-0.6f * (log2Q + log2QSteps[i]));
+    }
+}
+
+void CombProcessor::updateFilterSettings(float curFreq)
+{
+    float nyquist = sampleRate / 2.0f;
     
-    if (harmFreq > nyquist)
+    numInRange = 0;
+    for (int i = 0; i < numFilters; ++i)
     {
-        switch (mode) {
-            case FreqOutOfBoundsMode::Ignore:
-                return false;
-                break;
-                
-            case FreqOutOfBoundsMode::Wrap:
-                while (harmFreq >= nyquist)
-                    harmFreq -= nyquist;
-                
-                harmFreq += 20.0f;
-                break;
+        float harmFreq = curFreq * ratios[i];
+        
+        if (harmFreq > nyquist)
+        {
+            switch (mode) {
+                case FreqOutOfBoundsMode::Ignore:
+                    break;
                 
-            case FreqOutOfBoundsMode::Fold:
-                while (harmFreq >= nyquist || harmFreq < 20.0f)
-                    harmFreq = (harmFreq - nyquist) - nyquist;
-                break;
+                case FreqOutOfBoundsMode::Wrap:
+                    while (harmFreq >= nyquist)
+                        harmFreq -= nyquist;
+                    
+                    harmFreq += 20.0f;
+                    break;
                 
-            default:
-                DBG("No mode specified");
-                return false;
+                case FreqOutOfBoundsMode::Fold:
+                    // reflected off Nyquist, and off DC past the sample rate
+                    harmFreq = std::fmod(harmFreq, 2.0f * nyquist);
+                    if (harmFreq > nyquist)
+                        harmFreq = 2.0f * nyquist - harmFreq;
+                    
+                    harmFreq = jmax(harmFreq, 20.0f);
+                    break;
+            }
+            
+            if (harmFreq > nyquist)
                 break;
         }
+        
+        harmFreqs[i] = harmFreq;
+        ++numInRange;
     }
     
-    for (int ch = 0; ch < numChannels; ++ch)
+    updateLevels();
+    
+    ringTimeConstant = 0.0f;
+    for (int i = 0; i < numInRange; ++i)
+    {
+        slotFreqs[slotOf(i)] = harmFreqs[i];
+        slotQs[slotOf(i)] = harmQs[i] * levelQScales[i];
+        
+        // a bandpass's impulse response decays as exp(-pi * f * t / Q), with
+        // the Q the filter actually runs at on its level
+        ringTimeConstant = jmax(ringTimeConstant, slotQs[slotOf(i)] / (Pi * jmax(harmFreqs[i], 1.0f)));
+    }
+    
+    // the harmonics on a level are one run of indices unless Wrap or Fold
+    // moved some, either way each level gets the span from its first to its
+    // last
+    std::array<int, SubbandProcessor::maxLevels> first, last;
+    first.fill(numInRange);
+    last.fill(-1);
+    
+    for (int i = 0; i < numInRange; ++i)
     {
-        chain[ch][i].get<ChainPositions::Filter>().setCutoffFrequency(harmFreq);
-        chain[ch][i].get<ChainPositions::Filter>().setResonance(harmQ);
+        first[harmLevels[i]] = jmin(first[harmLevels[i]], i);
+        last[harmLevels[i]] = i;
     }
     
-    return true;
+    for (int level = 0; level < subbands.getNumLevels(); ++level)
+    {
+        if (last[level] < first[level])
+            continue;
+        
+        auto evenFirst = (first[level] + 1) / 2, evenEnd = last[level] / 2 + 1;
+        auto oddFirst = first[level] / 2, oddEnd = (last[level] + 1) / 2;
+        
+        if (evenEnd > evenFirst)
+            setBankCoefficients(level, evenFirst, evenEnd - evenFirst);
+        
+        if (oddEnd > oddFirst)
+            setBankCoefficients(level, oddSlotOffset + oddFirst, oddEnd - oddFirst);
+        
+        numCoefficientUpdates += last[level] - first[level] + 1;
+    }
 }
 
-void CombProcessor::updateTimbre(float curTimbre, int i)
+void CombProcessor::updateLevels()
+{
+    auto numLevels = subbands.getNumLevels();
+    
+    if (numLevels == 1)
+        return;
+    
+    // relative -3 dB bandwidth of both engines at w = cutoff / Fs,
+    // sin(2pi * w) / (2pi * w)
+    auto bandwidthScale = [] (float w)
+    {
+        auto t = fastmath::tanPrewarp(w);
+        return 2.0f * t / ((1.0f + t * t) * Tau * w);
+    };
+    
+    auto invSampleRate = 1.0f / float(sampleRate);
+    
+    for (int i = 0; i < numInRange; ++i)
+    {
+        // each harmonic runs on the lowest-rate level whose passband covers
+        // it. It only moves down a level once it is 10% under that level's
+        // edge, so one sitting on an edge doesn't flip back and forth
+        auto level = jmin(harmLevels[i], numLevels - 1);
+        
+        while (level > 0 && harmFreqs[i] > subbands.getPassbandEdge(level))
+            --level;
+        
+        while (level + 1 < numLevels && harmFreqs[i] < 0.9f * subbands.getPassbandEdge(level + 1))
+            ++level;
+        
+        harmLevels[i] = level;
+        
+        // the bandwidth narrows towards Nyquist, and further on a lower-rate
+        // level, so scale Q down to keep the host-rate bandwidth and
+        // undo the lower peak in the gain
+        auto w = harmFreqs[i] * invSampleRate;
+        levelQScales[i] = level == 0 ? 1.0f : bandwidthScale(w * float(1 << level)) / bandwidthScale(w);
+    }
+    
+    // both change with frequency, so the gains need redoing
+    levelsChanged = true;
+}
+
+void CombProcessor::updateTimbre(float curTimbre)
 {
     float oddGain, evenGain;
     
     oddGain = -curTimbre + 1.f;
     evenGain = curTimbre;
     
-    for (int ch = 0; ch < numChannels; ++ch)
+    for (int i = 0; i < numFilters; ++i)
     {
         if (i == 0)
-            chain[ch][i].get<ChainPositions::Timbre>().setGainLinear(1.f);
+            timbreGains[i] = 1.f;
         else if (i % 2 == 1)
-            chain[ch][i].get<ChainPositions::Timbre>().setGainLinear(oddGain);
+            timbreGains[i] = oddGain;
         else if (i % 2 == 0)
-            chain[ch][i].get<ChainPositions::Timbre>().setGainLinear(evenGain);
+            timbreGains[i] = evenGain;
     }
 }
 
-/*
-void CombProcessor::updateCurve(float curCurve, float curQ, int i)
+void CombProcessor::updateCurve(float curCurve)
 {
-    float gain, normCurveGain, curveQ;
+    // same -100 dB floor as Decibels::decibelsToGain
+    for (int i = 0; i < numFilters; ++i)
+        curveGains[i] = curCurve * i > -100.0f ? fastmath::dbToGain( curCurve * i ) : 0.0f;
+}
+
+void CombProcessor::updateGains()
+{
+    // harmonics above Nyquist or dropped by setNumHarmonics() fade to zero,
+    // after which the bank culls them
+    auto numHarmonics = jmax(numFilters, numBankHarmonics);
     
-    curveQ = curQ * (float(i) / 2.f + 1);
+    auto numEven = (numHarmonics + 1) / 2, numOdd = numHarmonics / 2;
     
-    // compensate gain for tighter q values because nonlinear filter
-    normCurveGain = pow((1.f/curveQ), 0.6);
+    // a harmonic that changed level fades out on the old one and in on the
+    // new one over the same control interval
+    for (int level = 0; level < subbands.getNumLevels(); ++level)
+    {
+        for (int i = 0; i < numHarmonics; ++i)
+            slotGains[slotOf(i)] = i < numInRange && harmLevels[i] == level ? timbreGains[i] * curveGains[i] * qGains[i] / levelQScales[i] : 0.0f;
+        
+        setBankGains(level, 0, numEven);
+        setBankGains(level, oddSlotOffset, numOdd);
+    }
     
-    gain = pow((-1.f / float(MAX_NUM_FILTERS)) * float(i) + 1.f, (1.f / curCurve));
-    gain *= normCurveGain;
+    numBankHarmonics = numFilters;
+    levelsChanged = false;
+}
+
+ResonatorBank* CombProcessor::getBank(Engine bankEngine, int level)
+{
+    if (bankEngine == Engine::Modal)
+        return &modalBanks[level];
     
-    for (int ch = 0; ch < numChannels; ++ch)
-        chain[ch][i].get<ChainPositions::Curve>().setGainLinear(gain);
+    return &svfBanks[level];
+}
+
+ResonatorBank* CombProcessor::getProcessingBank(Engine bankEngine, int level)
+{
+    if (isAttachedToBatch() && level == 0)
+        return bankEngine == Engine::Modal ? static_cast<ResonatorBank*> (modalBatchBank) : svfBatchBank;
+    
+    return getBank(bankEngine == Engine::Modal ? Engine::Modal : Engine::SVF, level);
+}
+
+bool CombProcessor::isFadingBanks() const
+{
+    return fadeChanged && engine != Engine::Waveguide && fadingEngine != Engine::Waveguide;
 }
- */
 
-void CombProcessor::updateCurve(float curCurve, float curQ, int i)
+void CombProcessor::setBankCoefficients(int level, int firstSlot, int num)
 {
-    float gain, curveQ;
+    auto bankSlot = firstSlot * slotStride + slotOffset;
     
-    curveQ = curQ * (float(i) / 2.f + 1);
-    gain = Decibels::decibelsToGain( curCurve * i );
-    gain *= pow((1.f/curveQ), 0.6);
+    banks[level]->setCoefficients(slotFreqs.data() + firstSlot, slotQs.data() + firstSlot, num, bankSlot, slotStride);
     
-    for (int ch = 0; ch < numChannels; ++ch)
-        chain[ch][i].get<ChainPositions::Curve>().setGainLinear(gain);
+    if (isFadingBanks())
+        fadingBanks[level]->setCoefficients(slotFreqs.data() + firstSlot, slotQs.data() + firstSlot, num, bankSlot, slotStride);
+}
+
+void CombProcessor::setBankGains(int level, int firstSlot, int num)
+{
+    auto bankSlot = firstSlot * slotStride + slotOffset;
+    
+    if (! fadeChanged)
+    {
+        banks[level]->setGains(slotGains.data() + firstSlot, num, bankSlot, slotStride);
+        return;
+    }
+    
+    // mid crossfade each engine gets its share, which the banks ramp to
+    // across the interval
+    auto* gains = fadeGains.data() + firstSlot;
+    SIMD::copyWithMultiply(gains, slotGains.data() + firstSlot, bankShare, num);
+    banks[level]->setGains(gains, num, bankSlot, slotStride);
+    
+    if (isFadingBanks())
+    {
+        SIMD::copyWithMultiply(gains, slotGains.data() + firstSlot, 1.0f - bankShare, num);
+        fadingBanks[level]->setGains(gains, num, bankSlot, slotStride);
+    }
+}
+
+int CombProcessor::slotOf(int harmonic) const
+{
+    // Timbre mutes all odd or all even indices and Curve tapers towards the
+    // top, so with the two parities in separate halves the silent partials
+    // end up in whole SIMD groups the bank can cull
+    return harmonic % 2 == 0 ? harmonic / 2 : oddSlotOffset + harmonic / 2;
 }
 
 }
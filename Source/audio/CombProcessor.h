@@ -13,17 +13,10 @@
 
 #include <JuceHeader.h>
 #include "../config.h"
-
-using SVFilter = dsp::StateVariableTPTFilter<float>;
-using Gain = dsp::Gain<float>;
-using Chain = dsp::ProcessorChain<SVFilter, Gain, Gain>;
-
-enum ChainPositions
-{
-    Filter,
-    Timbre,
-    Curve
-};
+#include "FilterBank.h"
+#include "ModalBank.h"
+#include "WaveguideComb.h"
+#include "SubbandProcessor.h"
 
 namespace audio
 {
@@ -38,9 +31,16 @@ public:
         Fold
     };
     
+    enum class Engine
+    {
+        SVF,
+        Modal,
+        Waveguide
+    };
+    
     struct Parameters
     {
-        Parameters(float freq, float resonance, float timbre, float curve, float spread, float glide, FreqOutOfBoundsMode mode = FreqOutOfBoundsMode::Ignore)
+        Parameters(float freq, float resonance, float timbre, float curve, float spread, float glide, FreqOutOfBoundsMode mode = FreqOutOfBoundsMode::Ignore, int harmonics = HARMONICS_DEFAULT, Engine engine = Engine::SVF)
         {
             this->freq = freq;
             this->resonance = resonance;
@@ -49,10 +49,21 @@ public:
             this->spread = spread;
             this->mode = mode;
             this->glide = glide;
+            this->harmonics = harmonics;
+            this->engine = engine;
         }
         
         float freq, resonance, timbre, curve, spread, glide;
         FreqOutOfBoundsMode mode;
+        int harmonics;
+        Engine engine;
+    };
+    
+    // how many per-harmonic tables were reused or rebuilt during the last block
+    struct CacheStats
+    {
+        int hits = 0;
+        int recomputes = 0;
     };
     
     CombProcessor(unsigned int _maxNumFilters);
@@ -60,19 +71,135 @@ public:
     
     void prepare(const dsp::ProcessSpec& spec);
     void reset();
-    void process(AudioBuffer<float> &buffer, int numSamples, int startSample = 0);
+    // reset(), with every smoothed parameter jumped to its target, so what
+    // comes next doesn't depend on anything processed before
+    void restart();
+    // filters [startSample, startSample + numSamples) of input into the same
+    // samples of output, which may be the same buffer
+    void process(const AudioBuffer<float> &input, AudioBuffer<float> &output, int numSamples, int startSample = 0);
+    void process(AudioBuffer<float> &buffer, int numSamples, int startSample = 0) { process(buffer, buffer, numSamples, startSample); }
     void updateParams(Parameters params);
+    // updateParams(), with resonance, timbre, curve and spread going from
+    // wherever they are to the new values in exactly numSamples, for
+    // Synth's automation ramp. Later changes smooth over numSamples too
+    void rampParams(Parameters params, int numSamples);
     Parameters& getParams();
+    // the last updateParams(), the continuous ones being where getParams() is gliding to
+    Parameters getTargetParams() const;
     void setFrequency(float freq);
     void setCurveOffset(float offset);
+    void setControlInterval(int numSamples);
+    void setNumHarmonics(int numHarmonics);
+    // crossfades from the old engine to the new one over ENGINE_FADE_MS,
+    // see process()
+    void setEngine(Engine engine);
+    void setCullThreshold(float thresholdDb);
+    // run low partials at reduced rates, see SubbandProcessor, from
+    // MULTIRATE_MIN_HOST_RATE up. Takes effect on prepare()
+    void setMultirate(bool enabled);
     
+    // filter into one lane of a CombBatch's banks instead of this processor's
+    // own, which needs prepare() without multirate. prepare() detaches
+    void attachToBatch(FilterBank* svfBank, ModalBank* modalBank, int lane);
+    // fades the lane out in the batch banks
+    void detachFromBatch();
+    bool isAttachedToBatch() const { return batchLane >= 0; }
+    // for CombBatch, process() without processing: advance the parameters by
+    // one control interval and update the lane's targets
+    void advanceControl(int numControlSamples);
+    
+    int getControlInterval() const { return controlInterval; }
+    int getNumHarmonics() const { return numFilters; }
+    // bank slots the harmonics are spread over, see slotOf()
+    int getNumSlots() const { return int(slotGains.size()); }
+    // filter slots actually processed after culling, in multiples of the SIMD
+    // width, none for the waveguide
+    int getNumActiveHarmonics() const;
+    // samples the subband filters delay the output by, the same for every
+    // engine as the waveguide's input is delayed to match
+    int getLatency() const { return subbands.getLatency(); }
+    int getNumLevels() const { return subbands.getNumLevels(); }
+    Engine getEngine() const { return engine; }
+    bool isFadingEngine() const { return fadePosition < fadeLength; }
+    // both cover the last process() block or advanceControl() interval
+    int getNumCoefficientUpdates() const { return numCoefficientUpdates; }
+    CacheStats getCacheStats() const { return cacheStats; }
+    // seconds the comb rings on for after its input stops, until it has
+    // fallen by decibels, from the longest decaying harmonic at the last
+    // settings processed
+    float getRingTime(float decibels) const;
+
 private:
-    bool updateFilterSettings(float curFreq, float curQ, float curSpread, int i);
-    void updateTimbre(float curTimbre, int i);
-    void updateCurve(float curCurve, float curQ, int i);
-    void updateParamsObject(float freq, float resonance, float timbre, float curve, float spread);
+    void advanceParams(int numControlSamples);
+    // moves the engine crossfade on by one control interval, and gives the
+    // new engine's share of the output at the interval's start and end
+    void advanceFade(int numControlSamples, float& fadeFrom, float& fadeTo);
+    void endFade();
+    // the input delayed by getLatency(), for the waveguide
+    void delayWaveguideInput(const float* const* input, const float** delayed, int numSamples);
+    void updateHarmonics(float curFreq, float curQ, float curTimbre, float curCurve, float curSpread);
+    bool isDirty(float& cached, float value);
+    void updateRatios(float curSpread);
+    void updateResonances(float curQ);
+    void updateFilterSettings(float curFreq);
+    void updateLevels();
+    void updateTimbre(float curTimbre);
+    void updateCurve(float curCurve);
+    void updateGains();
+    int slotOf(int harmonic) const;
+    // writes the slot tables' [firstSlot, firstSlot + num) to the bank level is using
+    void setBankCoefficients(int level, int firstSlot, int num);
+    void setBankGains(int level, int firstSlot, int num);
+    // both bank engines are running, one fading into the other
+    bool isFadingBanks() const;
+    ResonatorBank* getBank(Engine bankEngine, int level);
+    // getBank(), or the batch's bank while attached
+    ResonatorBank* getProcessingBank(Engine bankEngine, int level);
+    
+    // one bank per engine and subband level, banks holds the current engine's
+    std::array<FilterBank, SubbandProcessor::maxLevels> svfBanks;
+    std::array<ModalBank, SubbandProcessor::maxLevels> modalBanks;
+    std::array<ResonatorBank*, SubbandProcessor::maxLevels> banks {};
+    SubbandProcessor subbands;
+    WaveguideComb waveguide;
+    // CombBatch banks and this processor's lane in them, slots laneWidth apart
+    FilterBank* svfBatchBank = nullptr;
+    ModalBank* modalBatchBank = nullptr;
+    int batchLane = -1, slotStride = 1, slotOffset = 0;
+    bool multirate = true;
+    Engine engine = Engine::SVF;
+    // after setEngine(), the engine fading out and, if it's a bank engine,
+    // its banks. banks keeps the last bank engine while the waveguide plays
+    Engine fadingEngine = Engine::SVF;
+    std::array<ResonatorBank*, SubbandProcessor::maxLevels> fadingBanks {};
+    int fadeLength = 0, fadePosition = 0;
+    // banks' share of the output at the end of this control interval, the
+    // fading banks get the rest. fadeChanged while either moved
+    float bankShare = 1.0f;
+    bool fadeChanged = false;
+    std::vector<float> fadeGains;
+    // the waveguide's output while the banks run next to it
+    std::array<std::vector<float>, ResonatorBank::maxChannels> waveguideOutput;
+    // the subbands' latency for the waveguide, and its delayed input
+    std::array<std::vector<float>, ResonatorBank::maxChannels> waveguideDelay, waveguideInput;
+    int waveguideDelayPos = 0;
+    // per-harmonic tables, sized for maxNumFilters in prepare()
+    std::vector<float> log2Harmonics, log2QSteps;
+    std::vector<float> ratios, harmFreqs, harmQs, qGains, timbreGains, curveGains;
+    // bank-ordered copies, see slotOf()
+    std::vector<float> slotFreqs, slotQs, slotGains;
+    int oddSlotOffset = 0, numBankHarmonics = 0;
+    // subband level each harmonic is filtered at, and the Q scale that
+    // keeps its bandwidth the same there
+    std::vector<int> harmLevels;
+    std::vector<float> levelQScales;
+    bool levelsChanged = false;
     
-    std::array< std::array<Chain, MAX_NUM_FILTERS>, 2 > chain;
+    // values the tables above were last built from
+    float cachedFreq = 0.0f, cachedQ = 0.0f, cachedTimbre = 0.0f, cachedCurve = 0.0f, cachedSpread = 0.0f;
+    FreqOutOfBoundsMode cachedMode = FreqOutOfBoundsMode::Ignore;
+    bool cacheValid = false;
+    CacheStats cacheStats;
     
     SmoothedValue<float, ValueSmoothingTypes::Multiplicative> freq, q, spread;
     SmoothedValue<float, ValueSmoothingTypes::Linear> timbre, curve;
@@ -80,9 +207,11 @@ private:
     Parameters curParams;
     float lastGlide = GLIDE_DEFAULT, glide = GLIDE_DEFAULT;
     
-    AudioBuffer<float> tempBuffer, outBuffer;
     unsigned int maxNumFilters;
-    int numFilters;
+    int numFilters, numInRange = 0;
+    // the longest decay time constant of any harmonic in range, Q / (pi * f)
+    float ringTimeConstant = 0.0f;
+    int controlInterval = CONTROL_INTERVAL, numCoefficientUpdates = 0;
     double sampleRate;
     static constexpr int numChannels = 2;
 };
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    Envelope.cpp
+    Created: 17 Oct 2026 12:37:37pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "Envelope.h"
+
+namespace audio
+{
+
+void Envelope::setSampleRate(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void Envelope::setParameters(const Parameters& newParameters)
+{
+    if (newParameters == parameters)
+        return;
+    
+    auto old = parameters;
+    parameters = newParameters;
+    
+    auto shapeChanged = parameters.shape != old.shape;
+    
+    // only the segment under way changes course, from the current level
+    switch (state)
+    {
+        case State::attack:
+            if (shapeChanged || parameters.attack != old.attack)
+                startSegment(State::attack, 1.0f, lengthOf(parameters.attack, 1.0f - level));
+            break;
+        
+        case State::decay:
+        case State::sustain:
+            if (shapeChanged || parameters.decay != old.decay || parameters.sustain != old.sustain)
+            {
+                // the full decay time from 1, and no longer than that to a new sustain level
+                auto distance = std::abs(level - parameters.sustain);
+                auto fraction = distance > 0.0f ? distance / jmax(1.0f - parameters.sustain, distance) : 0.0f;
+                startSegment(State::decay, parameters.sustain, lengthOf(parameters.decay, fraction));
+            }
+            break;
+        
+        case State::release:
+            if (shapeChanged || parameters.release != old.release)
+                startSegment(State::release, 0.0f, lengthOf(parameters.release, releaseLevel > 0.0f ? level / releaseLevel : 0.0f));
+            break;
+        
+        case State::idle:
+        default:
+            break;
+    }
+}
+
+void Envelope::noteOn()
+{
+    startSegment(State::attack, 1.0f, lengthOf(parameters.attack, 1.0f - level));
+}
+
+void Envelope::noteOff()
+{
+    if (state == State::idle)
+        return;
+    
+    releaseLevel = level;
+    startSegment(State::release, 0.0f, lengthOf(parameters.release, 1.0f));
+}
+
+void Envelope::reset()
+{
+    state = State::idle;
+    level = 0.0f;
+}
+
+void Envelope::render(float* levels, int numSamples)
+{
+    for (int done = 0; done < numSamples;)
+    {
+        // flat until the next noteOn() or noteOff()
+        if (state == State::idle || state == State::sustain)
+        {
+            std::fill(levels + done, levels + numSamples, level);
+            return;
+        }
+        
+        auto num = jmin(numSamples - done, length - position);
+        renderRamp(levels + done, num);
+        
+        position += num;
+        done += num;
+        
+        if (position == length)
+        {
+            level = target;
+            levels[done - 1] = target;
+            nextSegment();
+        }
+        else
+        {
+            level = levels[done - 1];
+        }
+    }
+}
+
+void Envelope::startSegment(State newState, float newTarget, int numSamples)
+{
+    state = newState;
+    
+    if (numSamples <= 0)
+    {
+        level = newTarget;
+        nextSegment();
+        return;
+    }
+    
+    start = level;
+    target = newTarget;
+    length = numSamples;
+    position = 0;
+    exponential = parameters.shape == Shape::Exponential;
+    
+    if (! exponential)
+    {
+        step = (target - start) / float(length);
+        return;
+    }
+    
+    // the curve heads for a point past the target that it would reach
+    // after infinitely long, and passes the target itself on the last sample
+    auto reach = 1.0 - std::exp(-double(exponentialCurvature));
+    auto end = double(start) + double(target - start) / reach;
+    
+    base = float(end);
+    delta = double(start) - end;
+    ratio = std::exp(-double(exponentialCurvature) / double(length));
+    
+    double power = 1.0;
+    for (auto& p : powers)
+    {
+        p = float(power);
+        power *= ratio;
+    }
+    
+    chunkRatio = std::pow(ratio, double(rampChunk));
+}
+
+void Envelope::nextSegment()
+{
+    switch (state)
+    {
+        case State::attack:
+            startSegment(State::decay, parameters.sustain, lengthOf(parameters.decay, 1.0f));
+            break;
+        
+        case State::decay:
+            state = State::sustain;
+            break;
+        
+        case State::release:
+            state = State::idle;
+            break;
+        
+        case State::idle:
+        case State::sustain:
+        default:
+            break;
+    }
+}
+
+void Envelope::renderRamp(float* levels, int numSamples)
+{
+    // no sample depends on the one before, so both run at vector width
+    if (! exponential)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            levels[i] = start + step * float(position + 1 + i);
+        
+        return;
+    }
+    
+    for (int done = 0; done < numSamples; done += rampChunk)
+    {
+        auto num = jmin(rampChunk, numSamples - done);
+        auto scale = float(delta);
+        
+        for (int i = 0; i < num; ++i)
+            levels[done + i] = base + scale * powers[i + 1];
+        
+        delta *= num == rampChunk ? chunkRatio : std::pow(ratio, double(num));
+    }
+}
+
+int Envelope::lengthOf(float seconds, float fraction) const
+{
+    return jmax(0, roundToInt(double(seconds) * double(fraction) * sampleRate));
+}
+
+}
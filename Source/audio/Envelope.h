@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    Envelope.h
+    Created: 17 Oct 2026 12:37:37pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <JuceHeader.h>
+
+namespace audio
+{
+
+/*
+    Attack, decay, sustain, release envelope rendered a segment at a time,
+    in place of juce::ADSR's one-sample-at-a-time state machine.
+
+    Each segment is a ramp of a whole number of samples, and render() fills
+    the part of it that falls in the block with no per-sample branching.
+    Sample i of a linear ramp is start + step * i. An exponential one is
+    base + delta * k^i, from a table of powers of k for one chunk of
+    samples, so both loops run at vector width. Every segment lands exactly
+    on its target on its last sample, then the next one starts. Sustain is
+    flat and idle is zero.
+
+    The timing follows ADSR: the attack rises from wherever the level is
+    at attack's rate, the decay takes decay seconds from 1 to the sustain
+    level, and the release takes release seconds from wherever noteOff()
+    finds it. The first sample of a note is already one step in.
+    Exponential segments cover the same samples with exponentialCurvature
+    time constants, so they move quickly at first and settle into the
+    target.
+
+    setParameters() can be called at any time. A segment in progress
+    carries on from the current level, to its new target at its new rate,
+    and a held note glides to a new sustain level at the decay rate.
+*/
+class Envelope
+{
+public:
+    enum class Shape
+    {
+        Linear,
+        Exponential
+    };
+    
+    struct Parameters
+    {
+        Parameters() {;}
+        Parameters(float attack, float decay, float sustain, float release, Shape shape = Shape::Linear)
+            : attack(attack), decay(decay), sustain(sustain), release(release), shape(shape) {;}
+        
+        bool operator== (const Parameters& other) const
+        {
+            return attack == other.attack && decay == other.decay && sustain == other.sustain
+                && release == other.release && shape == other.shape;
+        }
+        
+        bool operator!= (const Parameters& other) const { return ! (*this == other); }
+        
+        // seconds, and the sustain level
+        float attack = 0.1f, decay = 0.1f, sustain = 1.0f, release = 0.1f;
+        Shape shape = Shape::Linear;
+    };
+    
+    Envelope() {;}
+    ~Envelope() {;}
+    
+    void setSampleRate(double sampleRate);
+    void setParameters(const Parameters& newParameters);
+    const Parameters& getParameters() const { return parameters; }
+    
+    void noteOn();
+    void noteOff();
+    // straight to idle
+    void reset();
+    // writes the next numSamples levels
+    void render(float* levels, int numSamples);
+    
+    bool isActive() const { return state != State::idle; }
+    bool isReleasing() const { return state == State::release; }
+    // the level of the last sample rendered
+    float getLevel() const { return level; }
+    
+    static constexpr float exponentialCurvature = 5.0f;
+
+private:
+    enum class State
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+    
+    static constexpr int rampChunk = 64;
+    
+    // from the current level to target over numSamples, then on to the next state
+    void startSegment(State newState, float target, int numSamples);
+    void nextSegment();
+    void renderRamp(float* levels, int numSamples);
+    // the samples a segment takes to cover the given fraction of its full length
+    int lengthOf(float seconds, float fraction) const;
+    
+    Parameters parameters;
+    double sampleRate = 44100.0;
+    
+    State state = State::idle;
+    float level = 0.0f;
+    // the release's full length is for the level noteOff() found
+    float releaseLevel = 0.0f;
+    
+    // the segment being rendered, position samples into its length
+    float start = 0.0f, target = 0.0f;
+    int length = 0, position = 0;
+    bool exponential = false;
+    // linear: start + step * i. Exponential: base + delta * k^i, with delta
+    // taken to the current position and powers[i] = k^i
+    float step = 0.0f, base = 0.0f;
+    double delta = 0.0, ratio = 1.0, chunkRatio = 1.0;
+    std::array<float, rampChunk + 1> powers {};
+};
+
+}
+
+#endif // ENVELOPE_H
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    FilterBank.cpp
+    Created: 17 Oct 2026 11:11:40am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "FilterBank.h"
+
+namespace audio
+{
+
+void FilterBank::prepareGroups(int numGroups)
+{
+    for (auto* coefficients : { &g, &gTarget, &gStep, &R2Step })
+        coefficients->assign(numGroups, Vec::expand(0.0f));
+    
+    for (auto* coefficients : { &R2, &R2Target, &h, &hTarget })
+        coefficients->assign(numGroups, Vec::expand(1.0f));
+    
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        s1[ch].assign(numGroups, Vec::expand(0.0f));
+        s2[ch].assign(numGroups, Vec::expand(0.0f));
+    }
+}
+
+void FilterBank::setCoefficientTargets(const float* cutoffs, const float* resonances, int num, int firstSlot, int slotStride)
+{
+    auto* gLanes = lanes(gTarget) + firstSlot;
+    auto* R2Lanes = lanes(R2Target) + firstSlot;
+    auto* hLanes = lanes(hTarget) + firstSlot;
+    auto invSampleRate = static_cast<float> (1.0 / sampleRate);
+    
+    // same coefficient maths as dsp::StateVariableTPTFilter::update(), with
+    // the cutoff kept just below Nyquist so the filter stays stable
+    for (int slot = 0; slot < num; ++slot)
+    {
+        auto gSlot = fastmath::tanPrewarp(jmin(cutoffs[slot] * invSampleRate, 0.499f));
+        auto R2Slot = 1.0f / resonances[slot];
+        
+        gLanes[slot * slotStride] = gSlot;
+        R2Lanes[slot * slotStride] = R2Slot;
+        hLanes[slot * slotStride] = 1.0f / (1.0f + R2Slot * gSlot + gSlot * gSlot);
+    }
+}
+
+void FilterBank::clearGroup(int grp)
+{
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        s1[ch][grp] = Vec::expand(0.0f);
+        s2[ch][grp] = Vec::expand(0.0f);
+    }
+}
+
+void FilterBank::clearSlot(int slot)
+{
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        lanes(s1[ch])[slot] = 0.0f;
+        lanes(s2[ch])[slot] = 0.0f;
+    }
+}
+
+void FilterBank::processGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes)
+{
+    if (sumLanes)
+        ramping ? processGroups<true, true>(input, output, numChannels, numSamples)
+                : processGroups<false, true>(input, output, numChannels, numSamples);
+    else
+        ramping ? processGroups<true, false>(input, output, numChannels, numSamples)
+                : processGroups<false, false>(input, output, numChannels, numSamples);
+}
+
+template <bool rampCoefficients, bool sumLanes>
+void FilterBank::processGroups(const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    const auto one = Vec::expand(1.0f);
+    
+    for (int s = 0; s < numSamples; ++s)
+    {
+        Vec x[maxChannels], acc[maxChannels];
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            x[ch] = Vec::expand(input[ch][s]);
+            acc[ch] = Vec::expand(0.0f);
+        }
+        
+        for (int i = 0; i < numActiveGroups; ++i)
+        {
+            auto grp = activeGroups[i];
+            
+            if (rampCoefficients)
+            {
+                g[grp] += gStep[grp];
+                R2[grp] += R2Step[grp];
+                gain[grp] += gainStep[grp];
+                h[grp] = reciprocal(one + g[grp] * (g[grp] + R2[grp]));
+            }
+            
+            auto G = g[grp], H = h[grp], GR = G + R2[grp], gainGrp = gain[grp];
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto z1 = s1[ch][grp], z2 = s2[ch][grp];
+                
+                auto yHP = H * (x[ch] - z1 * GR - z2);
+                auto yBP = yHP * G + z1;
+                z1       = yHP * G + yBP;
+                auto yLP = yBP * G + z2;
+                z2       = yBP * G + yLP;
+                
+                s1[ch][grp] = z1;
+                s2[ch][grp] = z2;
+                acc[ch] += yBP * gainGrp;
+            }
+        }
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (sumLanes)
+                output[ch][s] = acc[ch].sum();
+            else
+                acc[ch].copyToRawArray(output[ch] + s * laneWidth);
+        }
+    }
+}
+
+void FilterBank::beginCoefficientRamp(float scale)
+{
+    for (int i = 0; i < numActiveGroups; ++i)
+    {
+        auto grp = activeGroups[i];
+        
+        gStep[grp] = (gTarget[grp] - g[grp]) * scale;
+        R2Step[grp] = (R2Target[grp] - R2[grp]) * scale;
+    }
+}
+
+void FilterBank::snapCoefficients()
+{
+    g = gTarget;
+    R2 = R2Target;
+    h = hTarget;
+}
+
+FilterBank::Vec FilterBank::reciprocal(Vec v)
+{
+    // SIMDRegister has no division, the compiler turns this into one vector divide
+    alignas(Vec::SIMDRegisterSize) float values[laneWidth];
+    v.copyToRawArray(values);
+    
+    for (int lane = 0; lane < laneWidth; ++lane)
+        values[lane] = 1.0f / values[lane];
+    
+    return Vec::fromRawArray(values);
+}
+
+}
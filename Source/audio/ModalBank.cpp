@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    ModalBank.cpp
+    Created: 17 Oct 2026 11:34:18am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "ModalBank.h"
+
+namespace audio
+{
+
+void ModalBank::prepareGroups(int numGroups)
+{
+    for (auto* coefficients : { &pRe, &pIm, &b, &pReTarget, &pImTarget, &bTarget, &pReStep, &pImStep, &bStep })
+        coefficients->assign(numGroups, Vec::expand(0.0f));
+    
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        yRe[ch].assign(numGroups, Vec::expand(0.0f));
+        yIm[ch].assign(numGroups, Vec::expand(0.0f));
+    }
+}
+
+void ModalBank::setCoefficientTargets(const float* cutoffs, const float* resonances, int num, int firstSlot, int slotStride)
+{
+    auto* pReLanes = lanes(pReTarget) + firstSlot;
+    auto* pImLanes = lanes(pImTarget) + firstSlot;
+    auto* bLanes = lanes(bTarget) + firstSlot;
+    auto invSampleRate = static_cast<float> (1.0 / sampleRate);
+    
+    for (int slot = 0; slot < num; ++slot)
+    {
+        auto w = jmin(cutoffs[slot] * invSampleRate, 0.499f);
+        
+        // cos and sin of 2pi * w from t = tan(pi * w)
+        auto t = fastmath::tanPrewarp(w);
+        auto norm = 1.0f / (1.0f + t * t);
+        auto cosW = (1.0f - t * t) * norm, sinW = 2.0f * t * norm;
+        
+        // e^(-sin(2pi * w) / (2 * Q)), 1 / (2 * ln(2)) = 0.72135
+        auto r = jmin(fastmath::exp2(-0.7213475204f * sinW / resonances[slot]), maxRadius);
+        
+        pReLanes[slot * slotStride] = r * cosW;
+        pImLanes[slot * slotStride] = r * sinW;
+        bLanes[slot * slotStride] = 2.0f * resonances[slot] * (1.0f - r);
+    }
+}
+
+void ModalBank::clearGroup(int grp)
+{
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        yRe[ch][grp] = Vec::expand(0.0f);
+        yIm[ch][grp] = Vec::expand(0.0f);
+    }
+}
+
+void ModalBank::clearSlot(int slot)
+{
+    for (int ch = 0; ch < maxChannels; ++ch)
+    {
+        lanes(yRe[ch])[slot] = 0.0f;
+        lanes(yIm[ch])[slot] = 0.0f;
+    }
+}
+
+void ModalBank::processGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes)
+{
+    if (sumLanes)
+        ramping ? processGroups<true, true>(input, output, numChannels, numSamples)
+                : processGroups<false, true>(input, output, numChannels, numSamples);
+    else
+        ramping ? processGroups<true, false>(input, output, numChannels, numSamples)
+                : processGroups<false, false>(input, output, numChannels, numSamples);
+}
+
+template <bool rampCoefficients, bool sumLanes>
+void ModalBank::processGroups(const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    for (int s = 0; s < numSamples; ++s)
+    {
+        Vec x[maxChannels], acc[maxChannels];
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            x[ch] = Vec::expand(input[ch][s]);
+            acc[ch] = Vec::expand(0.0f);
+        }
+        
+        for (int i = 0; i < numActiveGroups; ++i)
+        {
+            auto grp = activeGroups[i];
+            
+            if (rampCoefficients)
+            {
+                pRe[grp] += pReStep[grp];
+                pIm[grp] += pImStep[grp];
+                b[grp] += bStep[grp];
+                gain[grp] += gainStep[grp];
+            }
+            
+            auto C = pRe[grp], S = pIm[grp], B = b[grp], gainGrp = gain[grp];
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto re = yRe[ch][grp], im = yIm[ch][grp];
+                
+                auto newRe = C * re - S * im + B * x[ch];
+                im         = C * im + S * re;
+                
+                yRe[ch][grp] = newRe;
+                yIm[ch][grp] = im;
+                acc[ch] += newRe * gainGrp;
+            }
+        }
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (sumLanes)
+                output[ch][s] = acc[ch].sum();
+            else
+                acc[ch].copyToRawArray(output[ch] + s * laneWidth);
+        }
+    }
+}
+
+void ModalBank::beginCoefficientRamp(float scale)
+{
+    for (int i = 0; i < numActiveGroups; ++i)
+    {
+        auto grp = activeGroups[i];
+        
+        pReStep[grp] = (pReTarget[grp] - pRe[grp]) * scale;
+        pImStep[grp] = (pImTarget[grp] - pIm[grp]) * scale;
+        bStep[grp] = (bTarget[grp] - b[grp]) * scale;
+    }
+}
+
+void ModalBank::snapCoefficients()
+{
+    pRe = pReTarget;
+    pIm = pImTarget;
+    b = bTarget;
+}
+
+}
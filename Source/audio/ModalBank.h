@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    ModalBank.h
+    Created: 17 Oct 2026 11:34:18am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef MODALBANK_H
+#define MODALBANK_H
+
+#include <JuceHeader.h>
+#include "ResonatorBank.h"
+
+namespace audio
+{
+
+/*
+    Bank of two-pole modal resonators, one per harmonic "slot".
+
+    Each slot is a decaying complex phasor, y = p * y + b * x with
+    p = r * e^(i * 2pi * w) and w = cutoff / Fs, and its real part is the
+    output. The mapping matches FilterBank's bandpass, so the centre
+    frequency is the cutoff and b = 2 * Q * (1 - r) gives the same peak gain
+    of Q. r = e^(-sin(2pi * w) / (2 * Q)) gives the same -3 dB bandwidth as
+    the bilinear SVF. That bandwidth is cutoff / Q at low frequencies and
+    narrows towards Nyquist. The skirts differ slightly, since the
+    resonator has no zeros at DC and Nyquist.
+
+    A slot costs six multiplies and four adds per sample and channel, about
+    the same as the SVF, but the recurrence is two operations deep instead of
+    five and needs no division while ramping. Bench/BankBench.cpp compares
+    the two. p, b and the gain are ramped linearly by ResonatorBank. Any
+    straight line between two poles inside the unit circle stays inside it,
+    so unlike the SVF this is stable under any modulation. r is capped just
+    below 1 so float rounding in the phasor can't push |p| over 1.
+*/
+class ModalBank : public ResonatorBank
+{
+public:
+    ModalBank() {;}
+    ~ModalBank() {;}
+
+protected:
+    void prepareGroups(int numGroups) override;
+    void setCoefficientTargets(const float* cutoffs, const float* resonances, int num, int firstSlot, int slotStride) override;
+    void clearGroup(int grp) override;
+    void clearSlot(int slot) override;
+    void beginCoefficientRamp(float scale) override;
+    void snapCoefficients() override;
+    void processGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes) override;
+
+private:
+    template <bool rampCoefficients, bool sumLanes>
+    void processGroups(const float* const* input, float* const* output, int numChannels, int numSamples);
+    
+    // pole (pRe + i * pIm) and input gain b
+    std::vector<Vec> pRe, pIm, b;
+    std::vector<Vec> pReTarget, pImTarget, bTarget;
+    std::vector<Vec> pReStep, pImStep, bStep;
+    std::array<std::vector<Vec>, maxChannels> yRe, yIm;
+    
+    static constexpr float maxRadius = 1.0f - 1.0e-6f;
+};
+
+}
+
+#endif // MODALBANK_H
@@ -0,0 +1,293 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.cpp
+    Created: 17 Oct 2026 12:24:02pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "NoiseGenerator.h"
+
+namespace audio
+{
+
+namespace
+{
+    // lowbias32 by Chris Wellons
+    inline uint32 hash(uint32 x) noexcept
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+    
+    // Kellet's refined pink filter at 44.1 kHz, a parallel bank of one-poles
+    // plus a direct term and a one sample delayed term
+    constexpr double kelletRate = 44100.0;
+    constexpr float kelletPoles[] = { 0.99886f, 0.99332f, 0.969f, 0.8665f, 0.55f, -0.7616f };
+    constexpr float kelletGains[] = { 0.0555179f, 0.0750759f, 0.153852f, 0.3104856f, 0.5329522f, -0.016898f };
+    constexpr float kelletDirect = 0.5362f;
+    constexpr float kelletDelayed = 0.115926f;
+}
+
+void NoiseGenerator::prepare(double sampleRate)
+{
+    // the positive poles keep their corner frequencies, with the gains
+    // scaled to keep each one-pole's level below its corner. The negative
+    // one only shapes the top octave, so it stays put
+    for (int i = 0; i < numPinkPoles; ++i)
+    {
+        pinkPoles[i] = kelletPoles[i];
+        pinkGains[i] = kelletGains[i];
+        
+        if (kelletPoles[i] > 0.0f)
+        {
+            pinkPoles[i] = float(std::pow(double(kelletPoles[i]), kelletRate / sampleRate));
+            pinkGains[i] = kelletGains[i] * (1.0f - pinkPoles[i]) / (1.0f - kelletPoles[i]);
+        }
+    }
+    
+    // the impulse response's energy, so pink comes out at white's RMS
+    std::array<float, numPinkPoles> states {};
+    double energy = 0.0;
+    
+    for (int s = 0; s < int(sampleRate); ++s)
+    {
+        auto x = s == 0 ? 1.0f : 0.0f;
+        auto y = kelletDirect * x + (s == 1 ? kelletDelayed : 0.0f);
+        
+        for (int i = 0; i < numPinkPoles; ++i)
+        {
+            states[i] = pinkPoles[i] * states[i] + pinkGains[i] * x;
+            y += states[i];
+        }
+        
+        energy += double(y) * double(y);
+    }
+    
+    pinkGain = float(1.0 / std::sqrt(energy));
+    
+    // unity gain at DC would be far louder than white, so the one-pole's
+    // energy, g^2 / (1 - p^2), is set to one instead
+    brownPole = float(std::exp(-MathConstants<double>::twoPi * brownCutoff / sampleRate));
+    brownGain = std::sqrt(1.0f - brownPole * brownPole);
+    
+    segmentLength = uint64(colourSegmentSeconds * sampleRate);
+    warmUpLength = uint64(colourWarmUpSeconds * sampleRate);
+    
+    reset();
+}
+
+void NoiseGenerator::reset()
+{
+    position = 0;
+    filters.clear();
+    nextFilters.clear();
+    filtersSettled = true;
+}
+
+void NoiseGenerator::setStream(uint32 newStream)
+{
+    if (newStream == stream)
+        return;
+    
+    stream = newStream;
+    filtersSettled = false;
+}
+
+void NoiseGenerator::setColour(Colour newColour)
+{
+    if (newColour == colour)
+        return;
+    
+    // the filter that takes over starts where it would be had it been
+    // running all along, rather than wherever it was left
+    colour = newColour;
+    filtersSettled = false;
+}
+    
+void NoiseGenerator::setPosition(uint64 newPosition)
+{
+    if (newPosition == position)
+        return;
+    
+    position = newPosition;
+    filtersSettled = false;
+}
+
+void NoiseGenerator::process(float* const* output, int numChannels, int numSamples)
+{
+    jassert(numChannels <= maxChannels);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        fillWhite(output[ch], ch, position, numSamples);
+    
+    if (colour != Colour::White)
+    {
+        if (! filtersSettled)
+            replayFilters(numChannels);
+        
+        // the next segment warms up over the end of this one, and takes over
+        // at its start
+        auto warmUpStart = segmentLength - warmUpLength;
+        
+        for (int done = 0; done < numSamples;)
+        {
+            auto start = position + uint64(done);
+            auto offset = start % segmentLength;
+            auto end = offset < warmUpStart ? warmUpStart : segmentLength;
+            auto num = int(jmin(uint64(numSamples - done), end - offset));
+            
+            if (offset == 0)
+                filters = nextFilters;
+            
+            if (offset == warmUpStart)
+                nextFilters.clear();
+            
+            if (offset >= warmUpStart)
+                runFilters(nextFilters, start, start + uint64(num), numChannels);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                filterColour(output[ch] + done, ch, num, filters);
+            
+            done += num;
+        }
+    }
+    
+    filtersSettled = true;
+    position += uint64(numSamples);
+}
+
+void NoiseGenerator::fillWhite(float* output, int channel, uint64 start, int numSamples) const
+{
+    for (int done = 0; done < numSamples;)
+    {
+        // the counter's high word is part of the key, so split the block
+        // where the low word wraps
+        auto counter = uint32(start);
+        auto num = int(jmin(uint64(numSamples - done), (uint64(1) << 32) - counter));
+        auto high = hash(uint32(start >> 32));
+        auto key = hash((stream * uint32(maxChannels) + uint32(channel)) * 0x9e3779b9u ^ high);
+        
+        generateWhite(output + done, key, counter, num);
+        
+        start += uint64(num);
+        done += num;
+    }
+}
+
+void NoiseGenerator::generateWhite(float* output, uint32 key, uint32 counter, int numSamples) const
+{
+    constexpr auto scale = whiteLevel / 2147483648.0f;
+    
+    // no sample depends on another, so this runs at vector width
+    for (int i = 0; i < numSamples; ++i)
+        output[i] = float(int32(hash((counter + uint32(i)) ^ key))) * scale;
+}
+
+void NoiseGenerator::filterColour(float* samples, int channel, int numSamples, FilterState& state)
+{
+    if (colour == Colour::Pink)
+        filterPink(samples, channel, numSamples, state);
+    else if (colour == Colour::Brown)
+        filterBrown(samples, channel, numSamples, state);
+}
+
+void NoiseGenerator::filterPink(float* samples, int channel, int numSamples, FilterState& state)
+{
+    auto states = state.pink[size_t(channel)];
+    auto previous = state.pinkPrevious[size_t(channel)];
+    
+    for (int s = 0; s < numSamples; ++s)
+    {
+        auto x = samples[s];
+        auto y = kelletDirect * x + kelletDelayed * previous;
+        
+        for (int i = 0; i < numPinkPoles; ++i)
+        {
+            states[i] = pinkPoles[i] * states[i] + pinkGains[i] * x;
+            y += states[i];
+        }
+        
+        previous = x;
+        samples[s] = pinkGain * y;
+    }
+    
+    state.pink[size_t(channel)] = states;
+    state.pinkPrevious[size_t(channel)] = previous;
+}
+
+void NoiseGenerator::filterBrown(float* samples, int channel, int numSamples, FilterState& state)
+{
+    auto level = state.brown[size_t(channel)];
+    
+    for (int s = 0; s < numSamples; ++s)
+    {
+        level = brownPole * level + brownGain * samples[s];
+        samples[s] = level;
+    }
+    
+    state.brown[size_t(channel)] = level;
+}
+
+void NoiseGenerator::restartFilters(FilterState& state, uint64 segmentStart, int numChannels)
+{
+    state.clear();
+    
+    // the stream's first segment has no noise before it
+    if (segmentStart >= warmUpLength)
+        runFilters(state, segmentStart - warmUpLength, segmentStart, numChannels);
+}
+
+void NoiseGenerator::replayFilters(int numChannels)
+{
+    // the same samples through the same filters as playing up to here, so
+    // the same state to the bit. process() hands over to nextFilters at a
+    // segment's start, so that's where the restart goes
+    auto segmentStart = position - position % segmentLength;
+    restartFilters(nextFilters, segmentStart, numChannels);
+    filters = nextFilters;
+    runFilters(filters, segmentStart, position, numChannels);
+    
+    // and the next segment's warm-up, if it has started
+    auto warmUpStart = segmentStart + segmentLength - warmUpLength;
+    
+    if (position > warmUpStart)
+    {
+        nextFilters.clear();
+        runFilters(nextFilters, warmUpStart, position, numChannels);
+    }
+}
+
+void NoiseGenerator::runFilters(FilterState& state, uint64 from, uint64 to, int numChannels)
+{
+    constexpr int chunkSize = 256;
+    float chunk[chunkSize];
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        for (auto start = from; start < to; start += chunkSize)
+        {
+            auto num = int(jmin(uint64(chunkSize), to - start));
+            
+            fillWhite(chunk, ch, start, num);
+            filterColour(chunk, ch, num, state);
+        }
+    }
+}
+
+void NoiseGenerator::FilterState::clear()
+{
+    for (auto& states : pink)
+        states.fill(0.0f);
+    
+    pinkPrevious.fill(0.0f);
+    brown.fill(0.0f);
+}
+
+}
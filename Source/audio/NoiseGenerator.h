@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.h
+    Created: 17 Oct 2026 12:24:02pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef NOISEGENERATOR_H
+#define NOISEGENERATOR_H
+
+#include <JuceHeader.h>
+
+namespace audio
+{
+
+/*
+    Counter-based noise source for the Noise input mode.
+
+    Sample n of a channel is a hash of n, keyed by the stream and channel,
+    rather than the next step of a sequential generator. Every sample of a
+    block is computed independently of the others, with integer multiplies,
+    shifts and xors only, so the white fill auto-vectorises into one SIMD
+    sweep per channel. The hash is lowbias32, a full-avalanche 32-bit
+    mixer. The counter's high word goes into the key, so a stream doesn't
+    repeat for 2^64 samples.
+
+    Each stream is an independent sequence at no extra cost, so any number
+    of generators, or the two channels of one, stay decorrelated.
+
+    White noise is uniform in [-whiteLevel, whiteLevel). Pink is Paul
+    Kellet's refined filter, -3 dB per octave from 10 Hz to within a few dB
+    of Nyquist. Its poles are moved so the corners sit at the same
+    frequencies at any rate. Brown is a leaky integrator, -6 dB per octave
+    above brownCutoff. Both run serially per channel after the white fill,
+    and are scaled to the same RMS level as white.
+
+    Every colour is a function of the position alone, so setPosition() can
+    jump anywhere and give the same samples as playing up to it. The colour
+    filters restart from silence at the start of each colourSegmentSeconds
+    of the stream, after running over the colourWarmUpSeconds of noise
+    before it. That is 12 time constants of the slowest pole, so a restart
+    is over 100 dB down. While playing, the next segment's filters warm up
+    next to the ones in use over the last colourWarmUpSeconds of each
+    segment, so crossing into it costs a block no more than any other, and
+    coloured noise costs 1.25 filter passes a sample rather than 1. A jump
+    replays the warm-up and the filters from the start of its segment, plus
+    the next segment's warm-up once it has started, at most
+    colourSegmentSeconds + 2 * colourWarmUpSeconds, 1.5 s.
+*/
+class NoiseGenerator
+{
+public:
+    enum class Colour
+    {
+        White,
+        Pink,
+        Brown
+    };
+    
+    NoiseGenerator() {;}
+    ~NoiseGenerator() {;}
+    
+    void prepare(double sampleRate);
+    // back to the start of the stream, with the colour filters cleared
+    void reset();
+    void setStream(uint32 stream);
+    void setColour(Colour newColour);
+    // carries on from sample newPosition of the stream, with the colour
+    // filters where they'd be having played up to it
+    void setPosition(uint64 newPosition);
+    // overwrites numSamples of each channel, numChannels <= maxChannels
+    void process(float* const* output, int numChannels, int numSamples);
+    
+    Colour getColour() const { return colour; }
+    uint64 getPosition() const { return position; }
+    
+    static constexpr int maxChannels = 2;
+    // the same spread as the nextFloat() * 0.5f this replaces, centred on zero
+    static constexpr float whiteLevel = 0.25f;
+    static constexpr float brownCutoff = 20.0f;
+    // the warm-up, the only second filter pass while playing, is the last
+    // quarter of each segment
+    static constexpr double colourSegmentSeconds = 1.0;
+    static constexpr double colourWarmUpSeconds = 0.25;
+
+private:
+    static constexpr int numPinkPoles = 6;
+    
+    // the colour filters' state for every channel
+    struct FilterState
+    {
+        void clear();
+        
+        std::array<std::array<float, numPinkPoles>, maxChannels> pink {};
+        std::array<float, maxChannels> pinkPrevious {}, brown {};
+    };
+    
+    // samples [start, start + numSamples) of a channel's white noise
+    void fillWhite(float* output, int channel, uint64 start, int numSamples) const;
+    void generateWhite(float* output, uint32 key, uint32 counter, int numSamples) const;
+    void filterColour(float* samples, int channel, int numSamples, FilterState& state);
+    void filterPink(float* samples, int channel, int numSamples, FilterState& state);
+    void filterBrown(float* samples, int channel, int numSamples, FilterState& state);
+    // clears the colour filters and warms them up on the noise before segmentStart
+    void restartFilters(FilterState& state, uint64 segmentStart, int numChannels);
+    // runs the colour filters over [from, to) of the stream, discarding the output
+    void runFilters(FilterState& state, uint64 from, uint64 to, int numChannels);
+    // the filters for position, and the next segment's warmed up to it
+    void replayFilters(int numChannels);
+    
+    Colour colour = Colour::White;
+    uint32 stream = 0;
+    uint64 position = 0;
+    uint64 segmentLength = 1, warmUpLength = 0;
+    // false once the filters no longer match the position, the stream or the colour
+    bool filtersSettled = true;
+    
+    std::array<float, numPinkPoles> pinkPoles {}, pinkGains {};
+    float pinkGain = 1.0f;
+    float brownPole = 0.0f, brownGain = 1.0f;
+    
+    // the ones in use, and the next segment's warming up
+    FilterState filters, nextFilters;
+};
+
+}
+
+#endif // NOISEGENERATOR_H
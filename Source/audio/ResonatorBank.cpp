@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    ResonatorBank.cpp
+    Created: 17 Oct 2026 11:34:18am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "ResonatorBank.h"
+
+namespace audio
+{
+
+void ResonatorBank::prepare(double _sampleRate, int _maxNumSlots)
+{
+    sampleRate = _sampleRate;
+    maxNumSlots = _maxNumSlots;
+    numGroups = (maxNumSlots + laneWidth - 1) / laneWidth;
+    
+    for (auto* values : { &gain, &gainTarget, &gainStep, &peak, &peakTarget })
+        values->assign(numGroups, Vec::expand(0.0f));
+    
+    activeGroups.assign(numGroups, 0);
+    groupActive.assign(numGroups, false);
+    numActiveGroups = 0;
+    
+    prepareGroups(numGroups);
+    
+    snapToTargets = true;
+}
+
+void ResonatorBank::reset()
+{
+    for (int grp = 0; grp < numGroups; ++grp)
+        clearGroup(grp);
+    
+    // every group is culled or not on its targets alone, with no hysteresis
+    // left over from before
+    std::fill(groupActive.begin(), groupActive.end(), false);
+    snapToTargets = true;
+}
+
+void ResonatorBank::setCoefficients(const float* cutoffs, const float* resonances, int num, int firstSlot, int slotStride)
+{
+    jassert(num == 0 || firstSlot + (num - 1) * slotStride < maxNumSlots);
+    
+    auto* peakLanes = lanes(peakTarget) + firstSlot;
+    for (int slot = 0; slot < num; ++slot)
+        peakLanes[slot * slotStride] = resonances[slot];
+    
+    setCoefficientTargets(cutoffs, resonances, num, firstSlot, slotStride);
+    targetsChanged = true;
+}
+
+void ResonatorBank::setGains(const float* gains, int num, int firstSlot, int slotStride)
+{
+    jassert(num == 0 || firstSlot + (num - 1) * slotStride < maxNumSlots);
+    
+    auto* gainLanes = lanes(gainTarget) + firstSlot;
+    for (int slot = 0; slot < num; ++slot)
+        gainLanes[slot * slotStride] = gains[slot];
+    
+    targetsChanged = true;
+}
+
+void ResonatorBank::clearSlots(int num, int firstSlot, int slotStride)
+{
+    jassert(num == 0 || firstSlot + (num - 1) * slotStride < maxNumSlots);
+    
+    for (int slot = 0; slot < num; ++slot)
+        clearSlot(firstSlot + slot * slotStride);
+}
+
+void ResonatorBank::setCullThreshold(float thresholdDb)
+{
+    cullThreshold = Decibels::decibelsToGain(thresholdDb, -1000.0f);
+    targetsChanged = true;
+}
+
+void ResonatorBank::process(const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    process(input, output, numChannels, numSamples, true);
+}
+
+void ResonatorBank::processLanes(const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    process(input, output, numChannels, numSamples, false);
+}
+
+void ResonatorBank::process(const float* const* input, float* const* output, int numChannels, int numSamples, bool sumLanes)
+{
+    jassert(numChannels <= maxChannels);
+    
+    if (numSamples <= 0)
+        return;
+    
+    if (snapToTargets)
+    {
+        endRamp();
+        updateActiveGroups();
+        snapToTargets = false;
+    }
+    
+    if (targetsChanged)
+    {
+        updateActiveGroups();
+        beginRamp(numSamples);
+        runGroups(input, output, numChannels, numSamples, true, sumLanes);
+        endRamp();
+        
+        // groups that faded out during the ramp are culled next time
+        recheckActivity = true;
+    }
+    else
+    {
+        if (recheckActivity)
+        {
+            updateActiveGroups();
+            recheckActivity = false;
+        }
+        
+        runGroups(input, output, numChannels, numSamples, false, sumLanes);
+    }
+}
+
+void ResonatorBank::runGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes)
+{
+    // a silent bank, common on the subband levels no partial is using,
+    // skips the per-sample loop
+    if (numActiveGroups == 0)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            SIMD::clear(output[ch], sumLanes ? numSamples : numSamples * laneWidth);
+        
+        return;
+    }
+    
+    processGroups(input, output, numChannels, numSamples, ramping, sumLanes);
+}
+
+void ResonatorBank::updateActiveGroups()
+{
+    auto* gainLanes = lanes(gain);
+    auto* gainTargetLanes = lanes(gainTarget);
+    auto* peakLanes = lanes(peak);
+    auto* peakTargetLanes = lanes(peakTarget);
+    
+    numActiveGroups = 0;
+    
+    for (int grp = 0; grp < numGroups; ++grp)
+    {
+        // 6 dB of hysteresis so groups near the threshold don't flap
+        auto threshold = groupActive[grp] ? cullThreshold : 2.0f * cullThreshold;
+        bool audible = false;
+        
+        for (int slot = grp * laneWidth; slot < (grp + 1) * laneWidth; ++slot)
+        {
+            audible = audible
+                || std::abs(gainLanes[slot]) * peakLanes[slot] > threshold
+                || std::abs(gainTargetLanes[slot]) * peakTargetLanes[slot] > threshold;
+        }
+        
+        // drop the leftover ringing so the group restarts from silence
+        if (groupActive[grp] && ! audible)
+            clearGroup(grp);
+        
+        groupActive[grp] = audible;
+        
+        if (audible)
+            activeGroups[numActiveGroups++] = grp;
+    }
+}
+
+void ResonatorBank::beginRamp(int numSamples)
+{
+    auto scale = 1.0f / float(numSamples);
+    
+    for (int i = 0; i < numActiveGroups; ++i)
+    {
+        auto grp = activeGroups[i];
+        gainStep[grp] = (gainTarget[grp] - gain[grp]) * scale;
+    }
+    
+    beginCoefficientRamp(scale);
+}
+
+void ResonatorBank::endRamp()
+{
+    // land exactly on the targets so rounding never accumulates
+    gain = gainTarget;
+    peak = peakTarget;
+    snapCoefficients();
+    
+    targetsChanged = false;
+}
+
+}
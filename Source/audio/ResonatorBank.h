@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    ResonatorBank.h
+    Created: 17 Oct 2026 11:34:18am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef RESONATORBANK_H
+#define RESONATORBANK_H
+
+#include <JuceHeader.h>
+#include "../config.h"
+#include "FastMath.h"
+
+namespace audio
+{
+
+/*
+    Base for the banks of resonators CombProcessor sums its partials with,
+    one resonator per "slot". Engines derive from this and supply the filter
+    state, the coefficient maths and the per-sample recurrence. Ramping,
+    gains and culling live here.
+
+    Slots are stored structure-of-arrays in SIMD registers, laneWidth slots
+    to a group. setCoefficients() and setGains() only set targets. The next
+    process() call moves each engine's coefficients and the per-slot gain
+    linearly from their current values to those targets across the samples
+    it renders, so the caller decides the control rate by how many samples
+    it hands over per call. Slots that were silent fade in from zero gain
+    instead of stepping.
+
+    Every engine peaks at its resonance at the cutoff, so gain * resonance is
+    a slot's loudest output per unit input. A group is only run while that
+    level, at the start or the end of the current ramp, is above the cull
+    threshold for at least one of its lanes. A culled group has its state
+    cleared, and it comes back from silence once it is 6 dB above the
+    threshold again. Its coefficients keep tracking their targets while it is
+    off. Anything dropped this way was already below the threshold, so
+    culling and resuming are inaudible at the default -96 dB.
+
+    process() sums every slot into one output. processLanes() instead keeps
+    the laneWidth lanes apart, each summed over all groups, for CombBatch,
+    which gives each lane to a different voice. The setters' slotStride
+    then addresses one lane's slots, laneWidth apart.
+*/
+class ResonatorBank
+{
+public:
+    using Vec = dsp::SIMDRegister<float>;
+    
+    static constexpr int laneWidth = (int) Vec::SIMDNumElements;
+    static constexpr int maxChannels = 2;
+    
+    ResonatorBank() {;}
+    virtual ~ResonatorBank() {;}
+    
+    void prepare(double sampleRate, int maxNumSlots);
+    void reset();
+    // slots firstSlot, firstSlot + slotStride, ...
+    void setCoefficients(const float* cutoffs, const float* resonances, int num, int firstSlot = 0, int slotStride = 1);
+    void setGains(const float* gains, int num, int firstSlot = 0, int slotStride = 1);
+    // silences num slots from firstSlot, slotStride apart, leaving the rest
+    // of their groups ringing
+    void clearSlots(int num, int firstSlot = 0, int slotStride = 1);
+    void setCullThreshold(float thresholdDb);
+    void process(const float* const* input, float* const* output, int numChannels, int numSamples);
+    // output[ch] holds numSamples * laneWidth floats, SIMD aligned, with each
+    // lane's sum for sample s at s * laneWidth + lane
+    void processLanes(const float* const* input, float* const* output, int numChannels, int numSamples);
+    
+    int getNumSlots() const { return maxNumSlots; }
+    int getNumActiveSlots() const { return numActiveGroups * laneWidth; }
+
+protected:
+    // size coefficients and state for numGroups groups
+    virtual void prepareGroups(int numGroups) = 0;
+    // coefficient targets for num slots from firstSlot, slotStride apart
+    virtual void setCoefficientTargets(const float* cutoffs, const float* resonances, int num, int firstSlot, int slotStride) = 0;
+    virtual void clearGroup(int grp) = 0;
+    virtual void clearSlot(int slot) = 0;
+    // per-sample coefficient steps for the active groups
+    virtual void beginCoefficientRamp(float scale) = 0;
+    virtual void snapCoefficients() = 0;
+    // fused filter, gain and sum over the active groups, stepping gain and
+    // coefficients once per sample when ramping. With sumLanes false the
+    // lanes are written out separately, as in processLanes()
+    virtual void processGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes) = 0;
+    
+    static float* lanes(std::vector<Vec>& v) { return reinterpret_cast<float*> (v.data()); }
+    
+    std::vector<Vec> gain, gainTarget, gainStep;
+    // indices of the groups processGroups() runs, in ascending order
+    std::vector<int> activeGroups;
+    int numActiveGroups = 0;
+    double sampleRate = 44100.0;
+
+private:
+    void updateActiveGroups();
+    void process(const float* const* input, float* const* output, int numChannels, int numSamples, bool sumLanes);
+    void runGroups(const float* const* input, float* const* output, int numChannels, int numSamples, bool ramping, bool sumLanes);
+    void beginRamp(int numSamples);
+    void endRamp();
+    
+    // per-slot resonance, the engines' gain at the cutoff
+    std::vector<Vec> peak, peakTarget;
+    std::vector<bool> groupActive;
+    float cullThreshold = Decibels::decibelsToGain(CULL_THRESHOLD_DB);
+    
+    int maxNumSlots = 0, numGroups = 0;
+    bool targetsChanged = false, snapToTargets = true, recheckActivity = false;
+};
+
+}
+
+#endif // RESONATORBANK_H
@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    SubbandProcessor.cpp
+    Created: 17 Oct 2026 11:58:13am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "SubbandProcessor.h"
+
+namespace audio
+{
+
+void SubbandProcessor::prepare(double _sampleRate, int maxBlockSize, int _numLevels)
+{
+    sampleRate = _sampleRate;
+    numLevels = jlimit(1, maxLevels, _numLevels);
+    
+    auto coefficients = dsp::FilterDesign<float>::designFIRLowpassHalfBandEquirippleMethod(transitionWidth, stopbandDb);
+    auto* taps = coefficients->getRawCoefficients();
+    numTaps = int(coefficients->getFilterOrder()) + 1;
+    jassert(numTaps % 4 == 3);
+    
+    halfLength = (numTaps + 1) / 4;
+    auto centre = (numTaps - 1) / 2;
+    centreTap = taps[centre];
+    sideTaps.resize(halfLength);
+    
+    for (int j = 0; j < halfLength; ++j)
+        sideTaps[j] = taps[centre + 2 * j + 1];
+    
+    // each level waits for the round trip through the level below it,
+    // which in turn waits for the ones below that
+    int delay = 0;
+    for (int level = numLevels - 2; level >= 0; --level)
+    {
+        delay = numTaps + 2 * delay;
+        levels[level].delay = delay;
+    }
+    
+    levels[numLevels - 1].delay = 0;
+    latency = levels[0].delay;
+    
+    for (int level = 0; level < numLevels; ++level)
+    {
+        auto& lv = levels[level];
+        auto blockSize = (maxBlockSize >> level) + 2;
+        bool hasLevelBelow = level + 1 < numLevels;
+        
+        for (int ch = 0; ch < maxChannels; ++ch)
+        {
+            lv.decimatorCentres[ch].assign(hasLevelBelow ? 2 * halfLength : 0, 0.0f);
+            lv.decimatorSides[ch].assign(hasLevelBelow ? 4 * halfLength : 0, 0.0f);
+            lv.interpolatorHistory[ch].assign(hasLevelBelow ? 4 * halfLength : 0, 0.0f);
+            lv.upsampled[ch].assign(hasLevelBelow ? blockSize + 2 : 0, 0.0f);
+            lv.delayLine[ch].assign(lv.delay, 0.0f);
+            lv.delayed[ch].assign(hasLevelBelow ? blockSize : 0, 0.0f);
+            lv.input[ch].assign(level > 0 ? blockSize : 0, 0.0f);
+            lv.output[ch].assign(level > 0 ? blockSize : 0, 0.0f);
+            lv.fading[ch].assign(blockSize, 0.0f);
+        }
+    }
+    
+    reset();
+}
+
+void SubbandProcessor::reset()
+{
+    for (auto& lv : levels)
+    {
+        for (int ch = 0; ch < maxChannels; ++ch)
+            for (auto* buffer : { &lv.decimatorCentres[ch], &lv.decimatorSides[ch], &lv.interpolatorHistory[ch], &lv.upsampled[ch], &lv.delayLine[ch] })
+                std::fill(buffer->begin(), buffer->end(), 0.0f);
+        
+        lv.centrePos = 0;
+        lv.sidePos = 0;
+        lv.interpolatorPos = 0;
+        lv.numLeftover = 1;
+        lv.delayPos = 0;
+        lv.oddSample = false;
+    }
+}
+
+void SubbandProcessor::process(ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    jassert(numChannels <= maxChannels);
+    
+    if (numSamples <= 0)
+        return;
+    
+    processLevel(0, banks, fadingBanks, input, output, numChannels, numSamples);
+}
+
+float SubbandProcessor::getPassbandEdge(int level) const
+{
+    if (level == 0)
+        return float(sampleRate / 2.0);
+    
+    return (0.25f - transitionWidth / 2.0f) * float(getLevelRate(level - 1));
+}
+
+void SubbandProcessor::processLevel(int level, ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    if (level + 1 == numLevels)
+    {
+        processBanks(level, banks, fadingBanks, input, output, numChannels, numSamples);
+        return;
+    }
+    
+    auto& lv = levels[level];
+    auto& below = levels[level + 1];
+    float* belowInput[maxChannels];
+    float* belowOutput[maxChannels];
+    const float* delayed[maxChannels];
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        belowInput[ch] = below.input[ch].data();
+        belowOutput[ch] = below.output[ch].data();
+        delayed[ch] = lv.delayed[ch].data();
+    }
+    
+    // everything that reads the input runs before the bank, which may
+    // overwrite it
+    auto numBelow = decimate(level, input, numChannels, numSamples);
+    delayInput(level, input, numChannels, numSamples);
+    
+    processLevel(level + 1, banks, fadingBanks, belowInput, belowOutput, numChannels, numBelow);
+    interpolate(level, numChannels, numBelow);
+    
+    processBanks(level, banks, fadingBanks, delayed, output, numChannels, numSamples);
+    
+    auto numUpsampled = lv.numLeftover + 2 * numBelow;
+    jassert(numUpsampled >= numSamples && numUpsampled <= numSamples + 1);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* upsampled = lv.upsampled[ch].data();
+        SIMD::add(output[ch], upsampled, numSamples);
+        
+        if (numUpsampled > numSamples)
+            upsampled[0] = upsampled[numSamples];
+    }
+    
+    lv.numLeftover = numUpsampled - numSamples;
+}
+
+void SubbandProcessor::processBanks(int level, ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    if (fadingBanks == nullptr)
+    {
+        banks[level]->process(input, output, numChannels, numSamples);
+        return;
+    }
+    
+    // the fading bank goes first, as the other may overwrite the input
+    float* fading[maxChannels];
+    for (int ch = 0; ch < numChannels; ++ch)
+        fading[ch] = levels[level].fading[ch].data();
+    
+    fadingBanks[level]->process(input, fading, numChannels, numSamples);
+    banks[level]->process(input, output, numChannels, numSamples);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        SIMD::add(output[ch], fading[ch], numSamples);
+}
+
+int SubbandProcessor::decimate(int level, const float* const* input, int numChannels, int numSamples)
+{
+    auto& lv = levels[level];
+    auto& below = levels[level + 1];
+    auto sideLength = 2 * halfLength;
+    int centrePos = lv.centrePos, sidePos = lv.sidePos, numOut = 0;
+    bool oddSample = lv.oddSample;
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* centres = lv.decimatorCentres[ch].data();
+        auto* sides = lv.decimatorSides[ch].data();
+        auto* out = below.input[ch].data();
+        centrePos = lv.centrePos;
+        sidePos = lv.sidePos;
+        oddSample = lv.oddSample;
+        numOut = 0;
+        
+        for (int s = 0; s < numSamples; ++s)
+        {
+            auto x = input[ch][s];
+            
+            if (! oddSample)
+            {
+                centres[centrePos] = centres[centrePos + halfLength] = x;
+                centrePos = centrePos + 1 == halfLength ? 0 : centrePos + 1;
+            }
+            else
+            {
+                sides[sidePos] = sides[sidePos + sideLength] = x;
+                sidePos = sidePos + 1 == sideLength ? 0 : sidePos + 1;
+                
+                // one output per two inputs. The centre tap sits K - 1 even
+                // samples back and the side taps pair up around it
+                auto* window = sides + sidePos + halfLength - 1;
+                auto y = 0.0f;
+                
+                for (int j = 0; j < halfLength; ++j)
+                    y += sideTaps[j] * (window[-j] + window[j + 1]);
+                
+                out[numOut++] = y + centreTap * centres[centrePos];
+            }
+            
+            oddSample = ! oddSample;
+        }
+    }
+    
+    lv.centrePos = centrePos;
+    lv.sidePos = sidePos;
+    lv.oddSample = oddSample;
+    return numOut;
+}
+
+void SubbandProcessor::interpolate(int level, int numChannels, int numSamples)
+{
+    auto& lv = levels[level];
+    auto& below = levels[level + 1];
+    auto historyLength = 2 * halfLength;
+    int pos = lv.interpolatorPos;
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* history = lv.interpolatorHistory[ch].data();
+        auto* in = below.output[ch].data();
+        auto* out = lv.upsampled[ch].data() + lv.numLeftover;
+        pos = lv.interpolatorPos;
+        
+        // zero-stuffed, so each output only sees every other tap, the centre
+        // tap alone for the even outputs and the side taps for the odd ones.
+        // Both are doubled to make up for the zeros
+        for (int s = 0; s < numSamples; ++s)
+        {
+            history[pos] = history[pos + historyLength] = in[s];
+            pos = pos + 1 == historyLength ? 0 : pos + 1;
+            
+            auto* window = history + pos + halfLength - 1;
+            auto odd = 0.0f;
+            
+            for (int j = 0; j < halfLength; ++j)
+                odd += sideTaps[j] * (window[-j] + window[j + 1]);
+            
+            *out++ = 2.0f * centreTap * window[0];
+            *out++ = 2.0f * odd;
+        }
+    }
+    
+    lv.interpolatorPos = pos;
+}
+
+void SubbandProcessor::delayInput(int level, const float* const* input, int numChannels, int numSamples)
+{
+    auto& lv = levels[level];
+    int pos = lv.delayPos;
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* line = lv.delayLine[ch].data();
+        auto* out = lv.delayed[ch].data();
+        pos = lv.delayPos;
+        
+        for (int s = 0; s < numSamples; ++s)
+        {
+            out[s] = line[pos];
+            line[pos] = input[ch][s];
+            pos = pos + 1 == lv.delay ? 0 : pos + 1;
+        }
+    }
+    
+    lv.delayPos = pos;
+}
+
+}
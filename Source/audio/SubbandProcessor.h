@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    SubbandProcessor.h
+    Created: 17 Oct 2026 11:58:13am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef SUBBANDPROCESSOR_H
+#define SUBBANDPROCESSOR_H
+
+#include <JuceHeader.h>
+#include "ResonatorBank.h"
+
+namespace audio
+{
+
+/*
+    Runs one ResonatorBank per octave subband, so low partials are filtered
+    at a fraction of the host rate.
+
+    Level 0 runs at the host rate, and each level below it runs at half the
+    rate of the one above. The input is split into levels by a chain of
+    polyphase half-band FIR decimators. Each level's bank filters its
+    subband, and matching half-band interpolators add the outputs back up
+    the chain. A bank at level l should only be given partials below
+    getPassbandEdge(l), 0.4 of its own rate. Below that edge the half-bands
+    are flat and anything that aliases into the level lies above it.
+
+    Latency: a decimate/interpolate round trip is numTaps samples at the
+    rate of the level above it (one more than the filters' group delay, so
+    that blocks of any length split evenly). Every level except the deepest
+    delays its own bank's input to line up with the levels below it, so the
+    whole processor delays by numTaps * (2^(numLevels - 1) - 1) host
+    samples. That's getLatency(), about 1 ms at 44.1 kHz with two levels
+    and about 3 ms at 96 or 192 kHz with the deepest level at 12 kHz. With
+    a single level nothing is split and there is no latency.
+*/
+class SubbandProcessor
+{
+public:
+    static constexpr int maxLevels = 5;
+    static constexpr int maxChannels = ResonatorBank::maxChannels;
+    
+    SubbandProcessor() {;}
+    ~SubbandProcessor() {;}
+    
+    void prepare(double sampleRate, int maxBlockSize, int numLevels);
+    void reset();
+    // banks[level] filters level's subband and writes its sum, output may alias input
+    void process(ResonatorBank* const* banks, const float* const* input, float* const* output, int numChannels, int numSamples)
+    {
+        process(banks, nullptr, input, output, numChannels, numSamples);
+    }
+    // the same, with fadingBanks[level] filtering the subband as well and
+    // added to banks[level], for a crossfade from one engine to another
+    void process(ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples);
+    
+    int getNumLevels() const { return numLevels; }
+    double getLevelRate(int level) const { return sampleRate / double(1 << level); }
+    // highest partial frequency the given level can take
+    float getPassbandEdge(int level) const;
+    // in host samples
+    int getLatency() const { return latency; }
+
+private:
+    struct Level
+    {
+        // decimator input history split into its two polyphase branches, the
+        // samples that line up with an output and the ones in between. Each
+        // sample is stored twice so the last K and 2K are always contiguous
+        std::array<std::vector<float>, maxChannels> decimatorCentres, decimatorSides;
+        // the last 2K samples from the level below, for the interpolator
+        std::array<std::vector<float>, maxChannels> interpolatorHistory;
+        // interpolated output, with up to one sample left over from the last block
+        std::array<std::vector<float>, maxChannels> upsampled;
+        // this level's bank input, delayed to line up with the levels below
+        std::array<std::vector<float>, maxChannels> delayLine, delayed;
+        // subband input and bank output when this level is below the host rate
+        std::array<std::vector<float>, maxChannels> input, output;
+        // the fading bank's output
+        std::array<std::vector<float>, maxChannels> fading;
+        
+        int centrePos = 0, sidePos = 0, interpolatorPos = 0, numLeftover = 1, delayPos = 0, delay = 0;
+        bool oddSample = false;
+    };
+    
+    void processLevel(int level, ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples);
+    void processBanks(int level, ResonatorBank* const* banks, ResonatorBank* const* fadingBanks, const float* const* input, float* const* output, int numChannels, int numSamples);
+    int decimate(int level, const float* const* input, int numChannels, int numSamples);
+    void interpolate(int level, int numChannels, int numSamples);
+    void delayInput(int level, const float* const* input, int numChannels, int numSamples);
+    
+    std::array<Level, maxLevels> levels;
+    // a half-band has only the centre tap and those at odd offsets from it,
+    // symmetric, so these are the taps at centre + 1, + 3, ...
+    std::vector<float> sideTaps;
+    float centreTap = 0.5f;
+    // numTaps = 4 * halfLength - 1
+    int numTaps = 0, halfLength = 0;
+    
+    int numLevels = 1, latency = 0;
+    double sampleRate = 44100.0;
+    
+    static constexpr float transitionWidth = 0.1f;
+    static constexpr float stopbandDb = -60.0f;
+};
+
+}
+
+#endif // SUBBANDPROCESSOR_H
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    WaveguideComb.cpp
+    Created: 17 Oct 2026 11:45:28am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "WaveguideComb.h"
+
+namespace audio
+{
+
+void WaveguideComb::prepare(const dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    
+    // long enough for the lowest MIDI note
+    auto maxDelay = int(std::ceil(sampleRate / midiToFreq(0))) + 4;
+    dsp::ProcessSpec lineSpec { sampleRate, spec.maximumBlockSize, uint32(maxChannels) };
+    
+    for (auto* line : { &fullLine, &halfLine })
+    {
+        line->setMaximumDelayInSamples(maxDelay);
+        line->prepare(lineSpec);
+    }
+    
+    dcCoefficient = 1.0f - Tau * dcCutoff / float(sampleRate);
+    reset();
+}
+
+void WaveguideComb::reset()
+{
+    fullLine.reset();
+    halfLine.reset();
+    
+    for (auto* state : { &fullState, &halfState, &resRe, &resIm, &dcIn, &dcOut })
+        state->fill(0.0f);
+    
+    snapToTargets = true;
+    cachedFreq = 0.0f;
+    solvedFreq = 0.0f;
+}
+
+void WaveguideComb::setParameters(float freq, float resonance, float timbre, float curve)
+{
+    if (freq == cachedFreq && resonance == cachedQ && timbre == cachedTimbre && curve == cachedCurve)
+        return;
+    
+    cachedFreq = freq;
+    cachedQ = resonance;
+    cachedTimbre = timbre;
+    cachedCurve = curve;
+    
+    auto period = float(sampleRate) / jmax(freq, 1.0f);
+    auto w = Tau / period;
+    auto cosW = std::cos(w);
+    auto curveGain = fastmath::dbToGain(curve);
+    
+    // loop gain per period, the half loop applies its gain twice per period
+    auto feedback = std::exp(-Tau / resonance);
+    auto feedbackHalf = std::sqrt(feedback);
+    
+    // the poles barely move with pitch, so a glide only re-solves them every
+    // few cents
+    if (resonance != solvedQ || curve != solvedCurve || std::abs(freq - solvedFreq) > poleTolerance * solvedFreq)
+    {
+        poleFull = solveLoopPole(feedback, w, 2, curveGain);
+        poleHalf = solveLoopPole(feedbackHalf, w, 3, curveGain * curveGain);
+        solvedFreq = freq;
+        solvedQ = resonance;
+        solvedCurve = curve;
+    }
+    
+    target[fullDelay] = jmax(minDelay, period - lowpassPhaseDelay(poleFull, w));
+    target[halfDelay] = jmax(minDelay, 0.5f * period - lowpassPhaseDelay(poleHalf, w));
+    target[fullFeedback] = feedback;
+    target[halfFeedback] = feedbackHalf;
+    target[fullPole] = poleFull;
+    target[halfPole] = poleHalf;
+    
+    // both loops normalised to unity at the fundamental, then the bank's
+    // level for it, Q * Q^-0.6
+    auto loopGain = feedback * lowpassMagnitude(poleFull, cosW);
+    auto level = fastmath::exp2(0.4f * fastmath::log2(resonance));
+    
+    target[fullGain] = (1.0f - timbre) * (1.0f - loopGain) * level;
+    target[halfGain] = (2.0f * timbre - 1.0f) * (1.0f - feedbackHalf * lowpassMagnitude(poleHalf, cosW)) * level;
+    target[fundamentalGain] = (1.0f - timbre) * level;
+    
+    // resonator with the full loop's bandwidth at the fundamental
+    auto radius = std::pow(loopGain, 1.0f / period);
+    target[poleRe] = radius * cosW;
+    target[poleIm] = radius * std::sin(w);
+    target[inputGain] = 2.0f * (1.0f - radius);
+}
+
+void WaveguideComb::process(const float* const* input, float* const* output, int numChannels, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+    
+    if (snapToTargets)
+    {
+        current = target;
+        snapToTargets = false;
+    }
+    
+    auto scale = 1.0f / float(numSamples);
+    for (int c = 0; c < numCoefficients; ++c)
+        step[c] = (target[c] - current[c]) * scale;
+    
+    for (int s = 0; s < numSamples; ++s)
+    {
+        for (int c = 0; c < numCoefficients; ++c)
+            current[c] += step[c];
+        
+        auto fullLeak = 1.0f - current[fullPole], halfLeak = 1.0f - current[halfPole];
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto x = input[ch][s];
+            
+            // one-pole lowpass on the delayed signal, then feed back
+            fullState[ch] += fullLeak * (fullLine.popSample(ch, current[fullDelay]) - fullState[ch]);
+            auto full = x + current[fullFeedback] * fullState[ch];
+            fullLine.pushSample(ch, full);
+            
+            halfState[ch] += halfLeak * (halfLine.popSample(ch, current[halfDelay]) - halfState[ch]);
+            auto half = x - current[halfFeedback] * halfState[ch];
+            halfLine.pushSample(ch, half);
+            
+            auto re = current[poleRe] * resRe[ch] - current[poleIm] * resIm[ch] + current[inputGain] * x;
+            resIm[ch] = current[poleRe] * resIm[ch] + current[poleIm] * resRe[ch];
+            resRe[ch] = re;
+            
+            auto y = current[fullGain] * full + current[halfGain] * half + current[fundamentalGain] * re;
+            
+            // the full loop also rings at DC
+            dcOut[ch] = y - dcIn[ch] + dcCoefficient * dcOut[ch];
+            dcIn[ch] = y;
+            output[ch][s] = dcOut[ch];
+        }
+    }
+    
+    current = target;
+}
+
+float WaveguideComb::lowpassMagnitude(float pole, float cosW)
+{
+    // |(1 - a) / (1 - a * e^(-iw))|
+    return (1.0f - pole) / std::sqrt(1.0f - 2.0f * pole * cosW + pole * pole);
+}
+
+float WaveguideComb::lowpassPhaseDelay(float pole, float w)
+{
+    return std::atan2(pole * std::sin(w), 1.0f - pole * std::cos(w)) / w;
+}
+
+float WaveguideComb::solveLoopPole(float feedback, float w, int harmonic, float ratio)
+{
+    // peak level of the given harmonic relative to the fundamental
+    auto cos1 = std::cos(w), cosH = std::cos(w * float(harmonic));
+    auto peakRatio = [&] (float pole)
+    {
+        return (1.0f - feedback * lowpassMagnitude(pole, cos1)) / (1.0f - feedback * lowpassMagnitude(pole, cosH));
+    };
+    
+    // the ratio falls as the pole rises, until the fundamental gets damped
+    // as well and it climbs back, so find that turning point first and
+    // bisect below it
+    float lo = 0.0f, hi = maxPole;
+    for (int i = 0; i < 16; ++i)
+    {
+        auto third = (hi - lo) / 3.0f;
+        
+        if (peakRatio(lo + third) < peakRatio(hi - third))
+            hi -= third;
+        else
+            lo += third;
+    }
+    
+    auto turningPoint = 0.5f * (lo + hi);
+    if (peakRatio(turningPoint) >= ratio)
+        return turningPoint;
+    
+    lo = 0.0f;
+    hi = turningPoint;
+    for (int i = 0; i < 16; ++i)
+    {
+        auto mid = 0.5f * (lo + hi);
+        
+        if (peakRatio(mid) > ratio)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    
+    return 0.5f * (lo + hi);
+}
+
+}
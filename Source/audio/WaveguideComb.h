@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    WaveguideComb.h
+    Created: 17 Oct 2026 11:45:28am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef WAVEGUIDECOMB_H
+#define WAVEGUIDECOMB_H
+
+#include <JuceHeader.h>
+#include "../config.h"
+
+namespace audio
+{
+
+/*
+    Feedback comb engine, a Karplus-Strong style loop whose cost does not
+    depend on the number of harmonics.
+
+    Two loops run in parallel on the input:
+
+    - the full loop, y = x + g * LP(y[n - L]), is one period long and rings
+      at every harmonic
+    - the half loop, y = x - sqrt(g) * LP(y[n - L/2]), inverts every half
+      period and rings at the odd harmonics only
+
+    Timbre crossfades between them the way it weights the bank's harmonics:
+    (1 - t) * full + (2t - 1) * half leaves the odd harmonics at t and the
+    even ones at 1 - t. That mix also scales the fundamental by t, so a
+    single modal resonator on the fundamental adds the missing (1 - t) back.
+
+    Resonance maps to the loop gain, g = e^(-2pi / Q). Each peak is then
+    about 2 * f0 / Q wide, the same as the bank's upper harmonics. Curve maps
+    to the one-pole lowpass inside both loops. Its pole is solved so the
+    second harmonic sits Curve dB below the fundamental (the third in the
+    half loop, 2 * Curve dB). Higher harmonics fall off faster and ring
+    shorter, as in a plucked string rather than exactly Curve dB per step.
+    The lowpass's phase delay at f0 is taken off the delay lengths to keep
+    the fundamental in tune.
+
+    Delays are read with third-order Lagrange interpolation. Every
+    coefficient is ramped linearly across each call to process(), so
+    setParameters() is meant to be called once per control interval.
+    Spread, Harmonics and Alias Mode don't apply, since a comb's partials
+    are always harmonic and stop at Nyquist.
+
+    A voice costs about as much as 30 to 50 bank partials whatever its
+    pitch, see Bench/BankBench.cpp, so it suits dense, low-pitched patches.
+*/
+class WaveguideComb
+{
+public:
+    WaveguideComb() {;}
+    ~WaveguideComb() {;}
+    
+    void prepare(const dsp::ProcessSpec& spec);
+    void reset();
+    void setParameters(float freq, float resonance, float timbre, float curve);
+    // output may alias input, numChannels <= maxChannels
+    void process(const float* const* input, float* const* output, int numChannels, int numSamples);
+    
+    static constexpr int maxChannels = 2;
+
+private:
+    enum Coefficient
+    {
+        fullDelay,
+        halfDelay,
+        fullFeedback,
+        halfFeedback,
+        fullPole,
+        halfPole,
+        fullGain,
+        halfGain,
+        fundamentalGain,
+        poleRe,
+        poleIm,
+        inputGain,
+        numCoefficients
+    };
+    
+    static float lowpassMagnitude(float pole, float cosW);
+    static float lowpassPhaseDelay(float pole, float w);
+    static float solveLoopPole(float feedback, float w, int harmonic, float ratio);
+    
+    using DelayLine = dsp::DelayLine<float, dsp::DelayLineInterpolationTypes::Lagrange3rd>;
+    DelayLine fullLine, halfLine;
+    
+    std::array<float, numCoefficients> current {}, target {}, step {};
+    std::array<float, maxChannels> fullState {}, halfState {}, resRe {}, resIm {}, dcIn {}, dcOut {};
+    
+    float cachedFreq = 0.0f, cachedQ = 0.0f, cachedTimbre = 0.0f, cachedCurve = 0.0f;
+    // loop lowpass poles and the values they were solved for
+    float poleFull = 0.0f, poleHalf = 0.0f;
+    float solvedFreq = 0.0f, solvedQ = 0.0f, solvedCurve = 0.0f;
+    float dcCoefficient = 0.0f;
+    bool snapToTargets = true;
+    double sampleRate = 44100.0;
+    
+    static constexpr float minDelay = 2.0f;     // Lagrange3rd reads one sample either side
+    static constexpr float maxPole = 0.99f;
+    static constexpr float poleTolerance = 0.002f;   // about 3.5 cents
+    static constexpr float dcCutoff = 20.0f;
+};
+
+}
+
+#endif // WAVEGUIDECOMB_H
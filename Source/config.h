@@ -1,11 +1,25 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "audio/FastMath.h"
+
 // GENERAL DEFINES
 #define A440                440.0f
-#define MAX_NUM_FILTERS     50
+#define MAX_NUM_FILTERS     256
 #define SMOOTH_SEC          0.01f
-#define NUM_VOICES          8
+#define NUM_STEAL_VOICES    2   // spare voices past the polyphony, so a stolen note can fade out while the new one starts
+#define STEAL_FADE_MS       5.0f
+#define ENGINE_FADE_MS      20.0f   // crossfade from the old comb engine to the new one when it changes
+#define CONTROL_INTERVAL    16  // samples per coefficient update in CombProcessor
+#define CULL_THRESHOLD_DB   -96.0f  // partials quieter than this are not processed
+#define SILENCE_THRESHOLD_DB -96.0f // a released voice quieter than this is freed
+#define SILENCE_WINDOW_MS   20.0f   // time constant a voice's measured level falls with
+#define MULTIRATE_MIN_RATE  12000.0 // lowest subband rate CombProcessor filters partials at
+#define MULTIRATE_MIN_HOST_RATE 88000.0 // below this host rate the subbands' latency buys too little to be worth it
+#define RENDER_THREADS      0   // worker threads rendering voices in parallel, 0 renders them all on the audio thread
+#define VOICE_BATCHING      0   // run voices side by side in SIMD lanes (CombBatch) instead of one by one with multirate
+#define AUTOMATION_SPLITTING 0  // ramp automated comb parameters across the block instead of stepping them per block
+#define AUTOMATION_INTERVAL 32  // samples per comb parameter update while ramping automation
 
 // PARAM DEFINES
 #define ATTACK_MIN          0.0f
@@ -35,15 +49,23 @@
 #define GLIDE_MIN           0.01f
 #define GLIDE_MAX           1.0f
 #define GLIDE_DEFAULT       0.01f
+#define HARMONICS_MIN       1
+#define HARMONICS_MAX       MAX_NUM_FILTERS
+#define HARMONICS_DEFAULT   50
+#define POLYPHONY_MIN       1
+#define POLYPHONY_MAX       64
+#define POLYPHONY_DEFAULT   8
 
 // NAMESPACE
 namespace audio
 {
     using SIMD = FloatVectorOperations;
+   #if JUCE_MODULE_AVAILABLE_juce_audio_processors
     using APVTS = AudioProcessorValueTreeState;
+   #endif
 
-    static float Pi = MathConstants<float>::pi;
-    static float Tau = MathConstants<float>::twoPi;
+    inline constexpr float Pi = MathConstants<float>::pi;
+    inline constexpr float Tau = MathConstants<float>::twoPi;
 
     template<typename Float>
     inline float msInSamples(Float ms, Float Fs) noexcept
@@ -54,12 +76,12 @@ namespace audio
     template<typename Float>
     inline float pitchToScalar(Float pitch) noexcept
     {
-        return pow(2.f, pitch / 12.f);
+        return fastmath::exp2(float(pitch) / 12.f);
     }
 
     inline float midiToFreq(int midiNote) noexcept
     {
-        return A440 * pow(2.0f, float( midiNote - 69.0f ) / 12.0f);
+        return A440 * fastmath::exp2(float( midiNote - 69.0f ) / 12.0f);
     }
 }
 
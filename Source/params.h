@@ -12,6 +12,7 @@ struct ChainSettings
     float decay {0};
     float sustain {0};
     float release {0};
+    int envelopeShape {0};
     
     // FILTER BANK SECTION
     float resonance {0};
@@ -21,33 +22,155 @@ struct ChainSettings
     
     float glide {0};
     
+    int harmonics {0};
+    int engine {0};
+    int polyphony {0};
     int inputMode {0};
+    int noiseColour {0};
     int aliasMode {0};
+    bool deterministic {false};
 };
 
-inline ChainSettings getChainSettings(APVTS& apvts)
+/*
+    Every parameter's value, read through std::atomic<float> handles looked
+    up by ID once on construction rather than on every read.
+
+    load() is const and only reads the atomics, so any thread can call it.
+    update() keeps the last values it read and reports which groups of
+    them changed since, so the audio thread only passes on what moved, and
+    an unchanged block costs one atomic load and compare per parameter.
+    Each thread that calls update() needs its own snapshot.
+*/
+class ParameterSnapshot
 {
-    ChainSettings settings;
+public:
+    // update()'s flags, one per group of parameters applied together
+    enum Changes
+    {
+        envelopeChanged = 1 << 0,   // Attack, Decay, Sustain, Release, Envelope Shape
+        combChanged = 1 << 1,       // Resonance, Timbre, Curve, Spread, Glide, Harmonics, Engine, Alias Mode
+        globalChanged = 1 << 2,     // Polyphony, Input Mode, Noise Colour, Deterministic
+        allChanged = envelopeChanged | combChanged | globalChanged
+    };
     
-    //==============================================================================
-    settings.attack = apvts.getRawParameterValue("Attack")->load();
-    settings.decay = apvts.getRawParameterValue("Decay")->load();
-    settings.sustain = apvts.getRawParameterValue("Sustain")->load();
-    settings.release = apvts.getRawParameterValue("Release")->load();
+    explicit ParameterSnapshot(APVTS& apvts) :
+        attack(apvts.getRawParameterValue("Attack")),
+        decay(apvts.getRawParameterValue("Decay")),
+        sustain(apvts.getRawParameterValue("Sustain")),
+        release(apvts.getRawParameterValue("Release")),
+        envelopeShape(apvts.getRawParameterValue("Envelope Shape")),
+        resonance(apvts.getRawParameterValue("Resonance")),
+        timbre(apvts.getRawParameterValue("Timbre")),
+        curve(apvts.getRawParameterValue("Curve")),
+        spread(apvts.getRawParameterValue("Spread")),
+        glide(apvts.getRawParameterValue("Glide")),
+        harmonics(apvts.getRawParameterValue("Harmonics")),
+        engine(apvts.getRawParameterValue("Engine")),
+        polyphony(apvts.getRawParameterValue("Polyphony")),
+        inputMode(apvts.getRawParameterValue("Input Mode")),
+        noiseColour(apvts.getRawParameterValue("Noise Colour")),
+        aliasMode(apvts.getRawParameterValue("Alias Mode")),
+        deterministic(apvts.getRawParameterValue("Deterministic"))
+    {
+        jassert(attack != nullptr && decay != nullptr && sustain != nullptr && release != nullptr && envelopeShape != nullptr
+                && resonance != nullptr && timbre != nullptr && curve != nullptr && spread != nullptr && glide != nullptr
+                && harmonics != nullptr && engine != nullptr && polyphony != nullptr && inputMode != nullptr
+                && noiseColour != nullptr && aliasMode != nullptr && deterministic != nullptr);
+    }
     
-    //==============================================================================
-    settings.resonance = apvts.getRawParameterValue("Resonance")->load();
-    settings.timbre = apvts.getRawParameterValue("Timbre")->load();
-    settings.curve = apvts.getRawParameterValue("Curve")->load();
-    settings.spread = apvts.getRawParameterValue("Spread")->load();
+    ChainSettings load() const
+    {
+        ChainSettings settings;
+        
+        //==============================================================================
+        settings.attack = attack->load();
+        settings.decay = decay->load();
+        settings.sustain = sustain->load();
+        settings.release = release->load();
+        settings.envelopeShape = envelopeShape->load();
+        
+        //==============================================================================
+        settings.resonance = resonance->load();
+        settings.timbre = timbre->load();
+        settings.curve = curve->load();
+        settings.spread = spread->load();
+        
+        settings.glide = glide->load();
+        
+        settings.harmonics = harmonics->load();
+        settings.engine = engine->load();
+        settings.polyphony = polyphony->load();
+        
+        settings.inputMode = inputMode->load();
+        settings.noiseColour = noiseColour->load();
+        settings.aliasMode = aliasMode->load();
+        settings.deterministic = deterministic->load() > 0.5f;
+        
+        return settings;
+    }
     
-    settings.glide = apvts.getRawParameterValue("Glide")->load();
+    // reads every parameter into get(), returning the Changes flags of the
+    // groups that differ from the last update(), or allChanged after
+    // invalidate() and on the first call
+    int update()
+    {
+        last = current;
+        current = load();
+        
+        if (! valid)
+        {
+            last = current;
+            valid = true;
+            return allChanged;
+        }
+        
+        int changes = 0;
+        
+        if (current.attack != last.attack || current.decay != last.decay || current.sustain != last.sustain
+            || current.release != last.release || current.envelopeShape != last.envelopeShape)
+            changes |= envelopeChanged;
+        
+        if (current.resonance != last.resonance || current.timbre != last.timbre || current.curve != last.curve
+            || current.spread != last.spread || current.glide != last.glide || current.harmonics != last.harmonics
+            || current.engine != last.engine || current.aliasMode != last.aliasMode)
+            changes |= combChanged;
+        
+        if (current.polyphony != last.polyphony || current.inputMode != last.inputMode
+            || current.noiseColour != last.noiseColour || current.deterministic != last.deterministic)
+            changes |= globalChanged;
+        
+        return changes;
+    }
     
-    settings.inputMode = apvts.getRawParameterValue("Input Mode")->load();
-    settings.aliasMode = apvts.getRawParameterValue("Alias Mode")->load();
+    // the next update() reports everything as changed
+    void invalidate() { valid = false; }
+    // the values the last update() read
+    const ChainSettings& get() const { return current; }
+    // the values the update() before that read, or get() after invalidate()
+    const ChainSettings& getLast() const { return last; }
+
+private:
+    std::atomic<float>* attack;
+    std::atomic<float>* decay;
+    std::atomic<float>* sustain;
+    std::atomic<float>* release;
+    std::atomic<float>* envelopeShape;
+    std::atomic<float>* resonance;
+    std::atomic<float>* timbre;
+    std::atomic<float>* curve;
+    std::atomic<float>* spread;
+    std::atomic<float>* glide;
+    std::atomic<float>* harmonics;
+    std::atomic<float>* engine;
+    std::atomic<float>* polyphony;
+    std::atomic<float>* inputMode;
+    std::atomic<float>* noiseColour;
+    std::atomic<float>* aliasMode;
+    std::atomic<float>* deterministic;
     
-    return settings;
-}
+    ChainSettings current, last;
+    bool valid = false;
+};
 
 static APVTS::ParameterLayout createParameterLayout()
 {
@@ -61,6 +184,8 @@ static APVTS::ParameterLayout createParameterLayout()
         (ParameterID ("Sustain", 1), "Sustain", SUSTAIN_MIN, SUSTAIN_MAX, SUSTAIN_DEFAULT);
     auto pRelease = std::make_unique<AudioParameterFloat>
         (ParameterID ("Release", 1), "Release", RELEASE_MIN, RELEASE_MAX, RELEASE_DEFAULT);
+    auto pEnvelopeShape = std::make_unique<AudioParameterChoice>
+        (ParameterID ("Envelope Shape", 1), "Envelope Shape", StringArray("Linear", "Exponential"), 0);
     
     auto pResonance = std::make_unique<AudioParameterFloat>
         (ParameterID ("Resonance", 1), "Resonance", RESONANCE_MIN, RESONANCE_MAX, RESONANCE_DEFAULT);
@@ -74,23 +199,40 @@ static APVTS::ParameterLayout createParameterLayout()
     auto pGlide = std::make_unique<AudioParameterFloat>
         (ParameterID ("Glide", 1), "Glide", GLIDE_MIN, GLIDE_MAX, GLIDE_DEFAULT);
     
+    auto pHarmonics = std::make_unique<AudioParameterInt>
+        (ParameterID ("Harmonics", 1), "Harmonics", HARMONICS_MIN, HARMONICS_MAX, HARMONICS_DEFAULT);
+    auto pEngine = std::make_unique<AudioParameterChoice>
+        (ParameterID ("Engine", 1), "Engine", StringArray("SVF", "Modal", "Waveguide"), 0);
+    auto pPolyphony = std::make_unique<AudioParameterInt>
+        (ParameterID ("Polyphony", 1), "Polyphony", POLYPHONY_MIN, POLYPHONY_MAX, POLYPHONY_DEFAULT);
+    
     auto pInputMode = std::make_unique<AudioParameterChoice>
         (ParameterID ("Input Mode", 1), "Input Mode", StringArray("Noise", "Ext"), 0);
+    auto pNoiseColour = std::make_unique<AudioParameterChoice>
+        (ParameterID ("Noise Colour", 1), "Noise Colour", StringArray("White", "Pink", "Brown"), 0);
     auto pAliasMode = std::make_unique<AudioParameterChoice>
         (ParameterID ("Alias Mode", 1), "Alias Mode", StringArray("Ignore", "Wrap", "Fold"), 0);
+    auto pDeterministic = std::make_unique<AudioParameterBool>
+        (ParameterID ("Deterministic", 1), "Deterministic", false);
         
     
     params.push_back(std::move(pAttack));
     params.push_back(std::move(pDecay));
     params.push_back(std::move(pSustain));
     params.push_back(std::move(pRelease));
+    params.push_back(std::move(pEnvelopeShape));
     params.push_back(std::move(pResonance));
     params.push_back(std::move(pTimbre));
     params.push_back(std::move(pCurve));
     params.push_back(std::move(pSpread));
     params.push_back(std::move(pGlide));
+    params.push_back(std::move(pHarmonics));
+    params.push_back(std::move(pEngine));
+    params.push_back(std::move(pPolyphony));
     params.push_back(std::move(pInputMode));
+    params.push_back(std::move(pNoiseColour));
     params.push_back(std::move(pAliasMode));
+    params.push_back(std::move(pDeterministic));
     
     return { params.begin(), params.end() };
 }
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    CommandQueue.cpp
+    Created: 17 Oct 2026 12:49:29pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "CommandQueue.h"
+
+bool CommandQueue::push(Command command)
+{
+    if (command.type != Command::Type::AllNotesOff)
+    {
+        pending.fetch_or(1u << uint32(command.type), std::memory_order_release);
+        return true;
+    }
+    
+    auto write = writeCount.load(std::memory_order_relaxed);
+    
+    // the consumer's release of the slot before it reads again
+    if (write - readCount.load(std::memory_order_acquire) == capacity)
+        return false;
+    
+    commands[write % capacity] = command;
+    writeCount.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandQueue::pop(Command& command)
+{
+    if (auto flags = pending.load(std::memory_order_relaxed))
+    {
+        auto panic = 1u << uint32(Command::Type::Panic);
+        command.type = (flags & panic) != 0 ? Command::Type::Panic : Command::Type::StateRestored;
+        
+        // the producer's writes before it set the flag, the restored state among them
+        pending.fetch_and(~(1u << uint32(command.type)), std::memory_order_acquire);
+        return true;
+    }
+    
+    auto read = readCount.load(std::memory_order_relaxed);
+    
+    if (read == writeCount.load(std::memory_order_acquire))
+        return false;
+    
+    command = commands[read % capacity];
+    readCount.store(read + 1, std::memory_order_release);
+    return true;
+}
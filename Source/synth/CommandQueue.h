@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    CommandQueue.h
+    Created: 17 Oct 2026 12:49:29pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+/*
+    Wait-free single producer, single consumer FIFO of commands from the
+    message thread to the audio thread, for what isn't a parameter.
+
+    A fixed ring of capacity commands with free-running read and write
+    counts, each written by one side only and on its own cache line. push()
+    and pop() are a handful of loads and stores with no loop, lock or
+    allocation, and a full queue drops the command instead of waiting.
+
+    A panic or state restore is a flag rather than a slot in the ring, as a
+    second one before the audio thread has seen the first adds nothing. So
+    they are never dropped, however many commands pile up while the audio
+    thread isn't running, and pop() hands them out before the ring, a panic
+    first.
+
+    Parameters, the engine and alias and input modes among them, go through
+    the APVTS instead, where ParameterSnapshot picks them up.
+*/
+class CommandQueue
+{
+public:
+    struct Command
+    {
+        enum class Type
+        {
+            // stops every voice at once, with no release
+            Panic,
+            // releases every voice
+            AllNotesOff,
+            // the state was replaced, so every parameter is applied again
+            StateRestored
+        };
+        
+        Type type;
+    };
+    
+    CommandQueue() {;}
+    ~CommandQueue() {;}
+    
+    // false if the queue is full, which a panic or state restore never is,
+    // from the producer thread only
+    bool push(Command command);
+    // takes the oldest command, false if there is none, from the consumer thread only
+    bool pop(Command& command);
+    
+    static constexpr uint32 capacity = 64;
+
+private:
+    std::array<Command, capacity> commands {};
+    // a bit per coalesced Type, set by the producer and cleared by the consumer
+    alignas(64) std::atomic<uint32> pending { 0 };
+    alignas(64) std::atomic<uint32> writeCount { 0 };
+    alignas(64) std::atomic<uint32> readCount { 0 };
+};
+
+#endif // COMMANDQUEUE_H
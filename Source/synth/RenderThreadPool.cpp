@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    RenderThreadPool.cpp
+    Created: 17 Oct 2026 12:01:46pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "RenderThreadPool.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    inline void spinPause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && ! JUCE_MSVC
+        __asm__ __volatile__ ("yield");
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+}
+
+void RenderThreadPool::Worker::run()
+{
+    // a workgroup is joined from the thread joining it, and left when the
+    // token goes
+    WorkgroupToken token;
+    
+    if (workgroup)
+        workgroup.join(token);
+    
+    pool.workerLoop();
+}
+
+void RenderThreadPool::start(int numThreads, int blockSize, double sampleRate, const AudioWorkgroup& workgroup)
+{
+    stop();
+    
+    quit.store(false);
+    tasks.store(0);
+    remaining.store(0);
+    finishWaiting.store(false);
+    
+    auto options = Thread::RealtimeOptions().withApproximateAudioProcessingTime(blockSize, sampleRate);
+    
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, workgroup));
+        
+        // without the rights to realtime scheduling (Linux), the highest
+        // ordinary priority
+        if (! worker->startRealtimeThread(options))
+            worker->startThread(Thread::Priority::highest);
+    }
+}
+
+void RenderThreadPool::stop()
+{
+    if (workers.isEmpty())
+        return;
+    
+    quit.store(true);
+    generation.fetch_add(1);
+    generation.notify_all();
+    
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+    
+    workers.clear();
+}
+
+void RenderThreadPool::run(int numTasks, Trampoline function, void* context)
+{
+    jassert(numTasks <= maxTasks);
+    
+    if (workers.isEmpty() || numTasks <= 1)
+    {
+        for (int t = 0; t < numTasks; ++t)
+            function(context, t);
+        
+        return;
+    }
+    
+    taskFunction = function;
+    taskContext = context;
+    remaining.store(numTasks, std::memory_order_relaxed);
+    tasks.store(uint32_t(numTasks) << 16, std::memory_order_release);
+    
+    // a worker either sees the new generation before it sleeps or is counted
+    // here, both sides being sequentially consistent
+    generation.fetch_add(1);
+    if (numSleeping.load() > 0)
+        generation.notify_all();
+    
+    while (runNextTask())
+        ;
+    
+    // the tasks still running are usually about done, but a worker that
+    // was preempted gets this core rather than a spin
+    for (int i = 0; i < finishSpinIterations && remaining.load(std::memory_order_acquire) > 0; ++i)
+        spinPause();
+    
+    if (remaining.load(std::memory_order_acquire) > 0)
+    {
+        // the last task either sees the flag and wakes this thread or is
+        // seen to have finished here, both sides being sequentially consistent
+        finishWaiting.store(true);
+        
+        for (auto left = remaining.load(); left > 0; left = remaining.load())
+            remaining.wait(left);
+        
+        finishWaiting.store(false);
+    }
+}
+
+bool RenderThreadPool::runNextTask()
+{
+    auto current = tasks.load(std::memory_order_acquire);
+    
+    for (;;)
+    {
+        auto task = int(current & 0xffff);
+        if (task >= int(current >> 16))
+            return false;
+        
+        if (tasks.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            taskFunction(taskContext, task);
+            
+            if (remaining.fetch_sub(1) == 1 && finishWaiting.load())
+                remaining.notify_one();
+            
+            return true;
+        }
+    }
+}
+
+void RenderThreadPool::workerLoop()
+{
+    auto seen = generation.load();
+    
+    while (! quit.load(std::memory_order_acquire))
+    {
+        while (runNextTask())
+            ;
+        
+        // the next block is usually a few milliseconds away, so only spin
+        // briefly before sleeping
+        for (int i = 0; i < spinIterations && generation.load(std::memory_order_acquire) == seen; ++i)
+            spinPause();
+        
+        if (generation.load() == seen)
+        {
+            numSleeping.fetch_add(1);
+            generation.wait(seen);
+            numSleeping.fetch_sub(1);
+        }
+        
+        seen = generation.load();
+    }
+}
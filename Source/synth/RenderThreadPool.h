@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    RenderThreadPool.h
+    Created: 17 Oct 2026 12:01:46pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef RENDERTHREADPOOL_H
+#define RENDERTHREADPOOL_H
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <thread>
+
+/*
+    Fixed set of worker threads that the audio thread can hand a batch of
+    independent tasks to, for rendering voices in parallel.
+
+    forEach() publishes the batch, wakes the workers, runs tasks itself as
+    well and returns once every task has finished. Tasks are claimed from a
+    single atomic counter and nothing is queued, so the audio thread never
+    allocates, locks or waits on anything but the batch's own completion.
+    Workers that find no work spin for a short while, then sleep on an
+    atomic wait (a futex on Linux). The audio thread only pays for the wake
+    call when at least one of them is asleep.
+
+    The workers are realtime threads sized to the block, and join the host's
+    audio workgroup where it has one (macOS), so the scheduler treats them
+    like the audio thread that waits on them. Should a worker still be held
+    up mid-task, the audio thread only spins on it briefly before sleeping
+    until it finishes, rather than keeping it off the core it needs.
+
+    Threads are only created and joined by start() and stop(), never from
+    forEach(). Tasks must not call forEach() themselves.
+*/
+class RenderThreadPool
+{
+public:
+    RenderThreadPool() {;}
+    ~RenderThreadPool() { stop(); }
+    
+    // numThreads workers on top of the calling thread, 0 runs everything
+    // inline. The block size and rate are the audio thread's, for the
+    // workers' realtime scheduling, and an invalid workgroup joins none
+    void start(int numThreads, int blockSize, double sampleRate, const AudioWorkgroup& workgroup = {});
+    void stop();
+    
+    int getNumThreads() const { return workers.size(); }
+    
+    // calls function(task) once for every task in [0, numTasks), in any order
+    // and on any thread
+    template <typename Function>
+    void forEach(int numTasks, Function& function)
+    {
+        run(numTasks, [] (void* context, int task) { (*static_cast<Function*> (context))(task); }, &function);
+    }
+    
+    static constexpr int maxTasks = 0xffff;
+
+private:
+    using Trampoline = void (*)(void*, int);
+    
+    class Worker : public Thread
+    {
+    public:
+        Worker(RenderThreadPool& owner, const AudioWorkgroup& group) : Thread("FineTooth render"), pool(owner), workgroup(group) {;}
+        
+        void run() override;
+        
+    private:
+        RenderThreadPool& pool;
+        const AudioWorkgroup workgroup;
+    };
+    
+    void run(int numTasks, Trampoline function, void* context);
+    void workerLoop();
+    bool runNextTask();
+    
+    OwnedArray<Worker> workers;
+    
+    // the batch, written before tasks is published
+    Trampoline taskFunction = nullptr;
+    void* taskContext = nullptr;
+    
+    // numTasks << 16 | next task to claim
+    alignas(64) std::atomic<uint32_t> tasks { 0 };
+    alignas(64) std::atomic<int> remaining { 0 };
+    // bumped for every batch, what idle workers sleep on
+    alignas(64) std::atomic<uint32_t> generation { 0 };
+    std::atomic<int> numSleeping { 0 };
+    std::atomic<bool> quit { false };
+    // set while the audio thread sleeps on remaining
+    std::atomic<bool> finishWaiting { false };
+    
+    // what a worker spins for before sleeping, and the audio thread before
+    // sleeping on a batch's last tasks
+    static constexpr int spinIterations = 4000;
+    static constexpr int finishSpinIterations = 1000;
+};
+
+#endif // RENDERTHREADPOOL_H
@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    Synth.cpp
+    Created: 17 Oct 2026 12:01:46pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "Synth.h"
+
+void Synth::prepare(int numRenderThreads, bool voiceBatching, int maxBlockSize)
+{
+    renderThreads.stop();
+    
+    // voices that weren't prepared again are still in the old batches' lanes
+    releaseBatchLanes();
+    
+    synthVoices.clear();
+    for (int i = 0; i < getNumVoices(); ++i)
+        if (auto voice = dynamic_cast<SynthVoice*>(getVoice(i)))
+            synthVoices.push_back(voice);
+    
+    activeVoices.resize(synthVoices.size());
+    
+    for (auto* voice : synthVoices)
+    {
+        voice->setExcitation(excitation);
+        voice->setDeterministic(deterministic);
+    }
+    
+    batches.clear();
+    
+    if (voiceBatching && ! synthVoices.empty())
+    {
+        auto numBatches = (int(synthVoices.size()) + audio::CombBatch::numLanes - 1) / audio::CombBatch::numLanes;
+        auto numSlots = synthVoices.front()->getCombProcessor().getNumSlots();
+        
+        for (int i = 0; i < numBatches; ++i)
+            batches.add(new audio::CombBatch())->prepare(getSampleRate(), maxBlockSize, numSlots);
+    }
+    
+    activeBatches.resize(size_t(batches.size()));
+    
+    // the audio thread renders a voice too, so more threads than that can't help
+    auto numTasks = batches.isEmpty() ? int(synthVoices.size()) : batches.size();
+    renderThreads.start(jlimit(0, jmax(0, numTasks - 1), numRenderThreads), maxBlockSize, getSampleRate(), workgroup);
+    
+    setPolyphony(polyphony);
+    numVoicesInUse = int(synthVoices.size());
+    ramping = false;
+}
+
+void Synth::releaseResources()
+{
+    renderThreads.stop();
+}
+
+void Synth::setExcitation(const AudioBuffer<float>& buffer)
+{
+    // usually the same buffer every block
+    if (&buffer == excitation)
+        return;
+    
+    excitation = &buffer;
+    
+    for (auto* voice : synthVoices)
+        voice->setExcitation(excitation);
+}
+
+void Synth::setDeterministic(bool shouldBeDeterministic)
+{
+    if (shouldBeDeterministic == deterministic)
+        return;
+    
+    deterministic = shouldBeDeterministic;
+    
+    for (auto* voice : synthVoices)
+        voice->setDeterministic(deterministic);
+}
+
+void Synth::stopAllVoices()
+{
+    for (auto* voice : synthVoices)
+        voice->stopImmediately();
+}
+
+void Synth::setNumVoicesInUse(int numVoices)
+{
+    numVoicesInUse = jlimit(0, int(synthVoices.size()), numVoices);
+    
+    for (size_t i = size_t(numVoicesInUse); i < synthVoices.size(); ++i)
+        if (synthVoices[i]->isVoiceActive() && ! synthVoices[i]->isStealFading())
+            synthVoices[i]->startStealFade();
+}
+
+bool Synth::isPlaying() const
+{
+    for (auto* voice : synthVoices)
+        if (voice->isVoiceActive())
+            return true;
+    
+    return false;
+}
+
+float Synth::getRingTime(float decibels) const
+{
+    float ringTime = 0.0f;
+    
+    for (auto* voice : synthVoices)
+        if (voice->isVoiceActive())
+            ringTime = jmax(ringTime, voice->getCombProcessor().getRingTime(decibels));
+    
+    return ringTime;
+}
+
+void Synth::setCombRamp(const audio::CombProcessor::Parameters& from, const audio::CombProcessor::Parameters& to, int blockLength)
+{
+    rampFrom = from;
+    rampTo = to;
+    rampLength = jmax(1, blockLength);
+    rampInterval = -1;
+    ramping = from.resonance != to.resonance || from.timbre != to.timbre || from.curve != to.curve || from.spread != to.spread;
+}
+
+void Synth::applyCombRamp(int startSample)
+{
+    auto interval = startSample / AUTOMATION_INTERVAL;
+    
+    // MIDI events can split an interval, which only needs setting once
+    if (interval == rampInterval)
+        return;
+    
+    rampInterval = interval;
+    
+    auto intervalEnd = jmin(rampLength, (interval + 1) * AUTOMATION_INTERVAL);
+    auto proportion = float(intervalEnd) / float(rampLength);
+    auto params = rampTo;
+    params.resonance = jmap(proportion, rampFrom.resonance, rampTo.resonance);
+    params.timbre = jmap(proportion, rampFrom.timbre, rampTo.timbre);
+    params.curve = jmap(proportion, rampFrom.curve, rampTo.curve);
+    params.spread = jmap(proportion, rampFrom.spread, rampTo.spread);
+    
+    // the combs get there by the interval's end, the last one being short
+    // when the block isn't a multiple of it
+    for (auto* voice : synthVoices)
+        voice->getCombProcessor().rampParams(params, intervalEnd - interval * AUTOMATION_INTERVAL);
+}
+
+void Synth::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    auto blockEnd = startSample + numSamples;
+    
+    while (startSample < blockEnd)
+    {
+        // a ramp moves the combs on at each grid point, and a stolen voice's
+        // waiting note starts on the sample after its fade
+        auto end = blockEnd;
+        
+        if (ramping)
+            end = jmin(end, (startSample / AUTOMATION_INTERVAL + 1) * AUTOMATION_INTERVAL);
+        
+        for (auto* voice : synthVoices)
+            if (voice->hasPendingNote())
+                end = jmin(end, startSample + jmax(1, voice->getPendingNoteDelay()));
+        
+        if (ramping)
+            applyCombRamp(startSample);
+        
+        renderSpan(outputAudio, startSample, end - startSample);
+        startSample = end;
+    }
+}
+
+void Synth::renderSpan(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    if (! batches.isEmpty() && excitation != nullptr)
+    {
+        if (! deterministic && synthVoices.front()->getCombProcessor().getEngine() != audio::CombProcessor::Engine::Waveguide)
+        {
+            renderBatches(outputAudio, startSample, numSamples);
+            return;
+        }
+        
+        releaseBatchLanes();
+    }
+    
+    if (renderThreads.getNumThreads() == 0)
+    {
+        Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+        return;
+    }
+    
+    int numActive = 0;
+    for (auto* voice : synthVoices)
+        if (voice->isVoiceActive())
+            activeVoices[numActive++] = voice;
+    
+    auto render = [this, startSample, numSamples] (int task) { activeVoices[task]->renderComb(startSample, numSamples); };
+    renderThreads.forEach(numActive, render);
+    
+    for (int i = 0; i < numActive; ++i)
+        activeVoices[i]->addToOutput(outputAudio, startSample, numSamples);
+}
+
+void Synth::renderBatches(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    constexpr auto numLanes = audio::CombBatch::numLanes;
+    
+    for (size_t i = 0; i < synthVoices.size(); ++i)
+    {
+        auto* voice = synthVoices[i];
+        batches[int(i) / numLanes]->setLane(int(i) % numLanes, voice->isVoiceActive() ? &voice->getCombProcessor() : nullptr);
+    }
+    
+    int numActive = 0;
+    for (auto* batch : batches)
+        if (! batch->isEmpty())
+            activeBatches[numActive++] = batch;
+    
+    auto numChannels = jmin(excitation->getNumChannels(), audio::CombBatch::maxChannels);
+    const float* input[audio::CombBatch::maxChannels];
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        input[ch] = excitation->getReadPointer(ch, startSample);
+    
+    auto render = [this, &input, numChannels, numSamples] (int task)
+    {
+        activeBatches[task]->process(input, numChannels, numSamples);
+    };
+    renderThreads.forEach(numActive, render);
+    
+    for (size_t i = 0; i < synthVoices.size(); ++i)
+    {
+        auto* voice = synthVoices[i];
+        
+        if (! voice->isVoiceActive())
+            continue;
+        
+        voice->renderFromBatch(*batches[int(i) / numLanes], int(i) % numLanes, startSample, numSamples);
+        voice->addToOutput(outputAudio, startSample, numSamples);
+    }
+}
+
+void Synth::releaseBatchLanes()
+{
+    for (auto* batch : batches)
+        for (int lane = 0; lane < audio::CombBatch::numLanes; ++lane)
+            batch->setLane(lane, nullptr);
+}
+
+SynthesiserVoice* Synth::findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    SynthVoice* freeVoice = nullptr;
+    int numPlaying = 0;
+    
+    for (int i = 0; i < numVoicesInUse; ++i)
+    {
+        auto* voice = synthVoices[size_t(i)];
+        
+        if (voice->isVoiceActive())
+            numPlaying += voice->isStealFading() ? 0 : 1;
+        else if (freeVoice == nullptr && voice->canPlaySound(soundToPlay))
+            freeVoice = voice;
+    }
+    
+    // the spares may all be busy fading, then the new note waits for the
+    // quietest of those to finish
+    if (numPlaying < polyphony)
+        return freeVoice != nullptr ? freeVoice : findQuietestVoice(soundToPlay, true);
+    
+    if (! stealIfNoneAvailable)
+        return nullptr;
+    
+    auto* stolen = static_cast<SynthVoice*> (findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber));
+    auto* spare = freeVoice != nullptr ? freeVoice : findQuietestVoice(soundToPlay, true);
+    
+    if (stolen != nullptr && spare != nullptr)
+    {
+        stolen->startStealFade();
+        return spare;
+    }
+    
+    return stolen;
+}
+
+SynthesiserVoice* Synth::findVoiceToSteal(SynthesiserSound* soundToPlay, int, int) const
+{
+    return findQuietestVoice(soundToPlay, false);
+}
+
+SynthVoice* Synth::findQuietestVoice(SynthesiserSound* soundToPlay, bool fading) const
+{
+    SynthVoice* quietest = nullptr;
+    auto quietestLevel = 0.0f;
+    
+    // a voice on its way out of the pool finishes its fade
+    for (int i = 0; i < numVoicesInUse; ++i)
+    {
+        auto* voice = synthVoices[size_t(i)];
+        
+        if (! voice->isVoiceActive() || voice->isStealFading() != fading || ! voice->canPlaySound(soundToPlay))
+            continue;
+        
+        auto level = voice->getLoudness();
+        
+        if (quietest == nullptr || level < quietestLevel)
+        {
+            quietest = voice;
+            quietestLevel = level;
+        }
+    }
+    
+    return quietest;
+}
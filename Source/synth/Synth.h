@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    Synth.h
+    Created: 17 Oct 2026 12:01:46pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <JuceHeader.h>
+#include "SynthVoice.h"
+#include "RenderThreadPool.h"
+#include "../audio/CombBatch.h"
+
+/*
+    Synthesiser that can render its voices on several cores, and batch them
+    across SIMD lanes.
+
+    Every voice reads the block's excitation from the one buffer passed to
+    setExcitation(), so only active voices touch it and nothing is copied
+    per voice.
+
+    With render threads, renderVoices() splits each voice's work in two. The
+    comb and envelope of every active voice run as one task each on the
+    RenderThreadPool. Once they have all finished, the voices are added to
+    the output on the calling thread in voice order, so the result is the
+    same sample for sample as rendering them one after another.
+
+    With voice batching, voice i plays in lane i % numLanes of CombBatch
+    i / numLanes for as long as it is active, so its filter state stays put.
+    The batches, each one task on the pool, filter the shared excitation.
+    Then every active voice takes its lane's output through its envelope
+    and into the output, again in voice order. The waveguide engine always
+    renders voice by voice. Without either option it renders exactly as
+    Synthesiser does.
+
+    With setCombRamp(), automation of the comb's continuous parameters is
+    followed within the block. The block is split on a grid of
+    AUTOMATION_INTERVAL samples as well as at its MIDI events, and before
+    each grid interval every voice's comb is set to where a straight line
+    from the last block's values to this block's is at the interval's end.
+    The MIDI and output stay where they are, with nothing copied.
+    
+    With setDeterministic(), each voice starts its notes from a cleared comb
+    and voices aren't batched, as a batch's lanes share culling and filter
+    state between voices. The output then only depends on the notes, the
+    settings and the excitation.
+
+    A released voice is freed as soon as its output has died away below
+    SILENCE_THRESHOLD_DB, rather than at the end of its release, except
+    with setDeterministic().
+    
+    Only setPolyphony() notes play at once, and the voices past that are
+    spares for stealing. When a note comes in over the limit, the quietest
+    playing voice by SynthVoice::getLoudness() is stolen. It fades out over
+    STEAL_FADE_MS while the new note starts on a spare, so nothing is cut
+    off. With every spare still fading, as when a chord change steals more
+    voices in one block than there are spares, the new note waits on the
+    quietest fading voice, or with none on the stolen voice itself. It
+    starts from a cleared comb once that fade is over, and renderVoices()
+    splits the block there, so no gain ever jumps on a ringing comb.
+    
+    setNumVoicesInUse() takes the voices past a count out of play when the
+    polyphony drops. They get no new notes and fade out as stolen ones do.
+*/
+class Synth : public Synthesiser
+{
+public:
+    // a MIDI event always splits the block, so notes start on their sample
+    Synth() { setMinimumRenderingSubdivisionSize(1); }
+    ~Synth() override {;}
+    
+    // call after the voices are added and prepared, never from the audio
+    // thread. Batching needs the voices' combs prepared without multirate
+    void prepare(int numRenderThreads, bool voiceBatching, int maxBlockSize);
+    void releaseResources();
+    // the host's audio workgroup, which the render threads join from the next prepare()
+    void setAudioWorkgroup(const AudioWorkgroup& audioWorkgroup) { workgroup = audioWorkgroup; }
+    // hands every batch lane back to its voice, before any voice is removed
+    void releaseBatchLanes();
+    // the input every voice's comb filters, read in place by the voices and batches
+    void setExcitation(const AudioBuffer<float>& buffer);
+    void setDeterministic(bool shouldBeDeterministic);
+    // over the next blockLength samples, moves every voice's comb from one
+    // set of parameters to the other, see renderVoices(). Nothing ramps if
+    // their resonance, timbre, curve and spread are the same
+    void setCombRamp(const audio::CombProcessor::Parameters& from, const audio::CombProcessor::Parameters& to, int blockLength);
+    bool isDeterministic() const { return deterministic; }
+    // notes that play at once, at most the number of voices
+    void setPolyphony(int numVoices) { polyphony = jlimit(1, jmax(1, getNumVoices()), numVoices); }
+    int getPolyphony() const { return polyphony; }
+    // the first numVoices voices play, the rest fade out and take no new
+    // notes, from the audio thread. prepare() puts every voice back in use
+    void setNumVoicesInUse(int numVoices);
+    
+    // silences and frees every voice at once, without a release, from the audio thread
+    void stopAllVoices();
+    // false once every voice has been freed, so a block without MIDI is silent
+    bool isPlaying() const;
+    // seconds the longest ringing active voice's comb takes to fall by
+    // decibels once its input stops
+    float getRingTime(float decibels) const;
+    
+    // every voice, as of the last prepare(), without a dynamic_cast each
+    const std::vector<SynthVoice*>& getSynthVoices() const { return synthVoices; }
+    int getNumRenderThreads() const { return renderThreads.getNumThreads(); }
+    bool isBatchingVoices() const { return ! batches.isEmpty(); }
+
+protected:
+    void renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+    SynthesiserVoice* findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const override;
+    SynthesiserVoice* findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber) const override;
+
+private:
+    // renderVoices() for a span the comb parameters hold still over, with
+    // no waiting note starting in it
+    void renderSpan(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+    // every voice's comb to the ramp's settings at the end of the interval starting at startSample
+    void applyCombRamp(int startSample);
+    void renderBatches(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+    // the quietest active voice that is or isn't fading out
+    SynthVoice* findQuietestVoice(SynthesiserSound* soundToPlay, bool fading) const;
+    
+    RenderThreadPool renderThreads;
+    AudioWorkgroup workgroup;
+    OwnedArray<audio::CombBatch> batches;
+    const AudioBuffer<float>* excitation = nullptr;
+    int polyphony = POLYPHONY_DEFAULT, numVoicesInUse = 0;
+    bool deterministic = false;
+    
+    audio::CombProcessor::Parameters rampFrom { -1.0f, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_DEFAULT };
+    audio::CombProcessor::Parameters rampTo { -1.0f, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_DEFAULT };
+    int rampLength = 0, rampInterval = -1;
+    bool ramping = false;
+    
+    std::vector<SynthVoice*> synthVoices, activeVoices;
+    std::vector<audio::CombBatch*> activeBatches;
+};
+
+#endif // SYNTH_H
@@ -17,16 +17,49 @@ bool SynthVoice::canPlaySound(juce::SynthesiserSound* sound)
 }
 
 void SynthVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound *sound, int currentPitchWheelPosition)
+{
+    // a voice that is still sounding, stolen or fading out, would click
+    // if its gain jumped back up on the comb's ringing
+    if (envelope.isActive())
+    {
+        startStealFade();
+        pendingNote = midiNoteNumber;
+        return;
+    }
+    
+    beginNote(midiNoteNumber, deterministic);
+}
+
+void SynthVoice::beginNote(int midiNoteNumber, bool clearComb)
 {
     comb.setFrequency(audio::midiToFreq(midiNoteNumber));
     
-//    adsr.reset();
-    adsr.noteOn();
+    if (clearComb)
+        comb.restart();
+    
+    stealing = false;
+    stealFadeLeft = 0;
+    pendingNote = -1;
+    stealGain.setCurrentAndTargetValue(1.0f);
+    combEnergy = 0.0f;
+    sounded = false;
+    
+    // after a fade the attack starts again from silence
+    envelope.reset();
+    envelope.noteOn();
 }
 
 void SynthVoice::stopNote(float velocity, bool allowTailOff)
 {
-    adsr.noteOff();
+    // a fading voice is on its way out already, and a note released
+    // before its voice's fade ended never starts
+    if (stealing)
+    {
+        pendingNote = -1;
+        return;
+    }
+    
+    envelope.noteOff();
 }
 
 void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue)
@@ -41,8 +74,16 @@ void SynthVoice::pitchWheelMoved(int newPitchWheelValue)
 
 void SynthVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels)
 {
-    // initialize adsr
-    adsr.setSampleRate(sampleRate);
+    // initialize envelope
+    envelope.setSampleRate(sampleRate);
+    stealFadeLength = jmax(1, roundToInt(STEAL_FADE_MS / 1000.0f * sampleRate));
+    stealGain.reset(stealFadeLength);
+    stealGain.setCurrentAndTargetValue(1.0f);
+    stealing = false;
+    stealFadeLeft = 0;
+    pendingNote = -1;
+    energyWindow = SILENCE_WINDOW_MS / 1000.0f * float(sampleRate);
+    silenceLevel = Decibels::decibelsToGain(SILENCE_THRESHOLD_DB);
     
     // initialize comb processor
     juce::dsp::ProcessSpec spec;
@@ -54,6 +95,7 @@ void SynthVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int outpu
     
     // initialize comb buffer
     combBuffer.setSize(outputChannels, samplesPerBlock);
+    gains.assign(size_t(samplesPerBlock), 0.0f);
     
     isPrepared = true;
 }
@@ -61,7 +103,7 @@ void SynthVoice::prepareToPlay(double sampleRate, int samplesPerBlock, int outpu
 void SynthVoice::reset()
 {
 //    comb.reset();
-    adsr.reset();
+    envelope.reset();
 }
 
 void SynthVoice::renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
@@ -73,27 +115,127 @@ void SynthVoice::renderNextBlock(AudioBuffer<float> &outputBuffer, int startSamp
         return;
     }
     
-    auto buffer = combBuffer.getArrayOfWritePointers();
+    renderComb(startSample, numSamples);
+    addToOutput(outputBuffer, startSample, numSamples);
+}
+
+void SynthVoice::renderComb(int startSample, int numSamples)
+{
+    jassert(excitation != nullptr);
     
-    comb.process(combBuffer, numSamples);
+    // a sub-block between two MIDI events filters its own stretch of the
+    // excitation into the same stretch of combBuffer
+    comb.process(*excitation, combBuffer, numSamples, startSample);
     
-    adsr.applyEnvelopeToBuffer(combBuffer, 0, numSamples);
-//    for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-//        for (int s = 0; s < numSamples; ++s)
-//            buffer[ch][s] *= adsr.getNextSample();
+    renderEnvelope(startSample, numSamples);
+}
+
+void SynthVoice::renderFromBatch(const audio::CombBatch& batch, int lane, int startSample, int numSamples)
+{
+    auto numChannels = jmin(combBuffer.getNumChannels(), audio::CombBatch::maxChannels);
+    float* buffer[audio::CombBatch::maxChannels];
     
-    for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-        outputBuffer.addFrom(ch, 0, buffer[ch], numSamples);
+    for (int ch = 0; ch < numChannels; ++ch)
+        buffer[ch] = combBuffer.getWritePointer(ch, startSample);
     
-    if (! adsr.isActive())
-        clearCurrentNote();
+    batch.copyLaneOutput(lane, buffer, numChannels, numSamples);
+    
+    renderEnvelope(startSample, numSamples);
 }
 
-void SynthVoice::fillBuffer(AudioBuffer<float> &buffer, int numSamples)
+void SynthVoice::renderEnvelope(int startSample, int numSamples)
 {
-    auto inBuffer = buffer.getArrayOfReadPointers();
-    auto outBuffer = combBuffer.getArrayOfWritePointers();
+    auto numChannels = combBuffer.getNumChannels();
+    float sumSquares = 0.0f;
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* samples = combBuffer.getReadPointer(ch, startSample);
+        
+        for (int s = 0; s < numSamples; ++s)
+            sumSquares += samples[s] * samples[s];
+    }
     
-    for (int ch = 0; ch < 2; ++ch)
-        audio::SIMD::copy(outBuffer[ch], inBuffer[ch], numSamples);
+    if (numSamples > 0)
+    {
+        auto meanSquare = sumSquares / float(numSamples * numChannels);
+        combLevel = std::sqrt(meanSquare);
+        
+        // jumps up at once and falls away slowly, so a sub-block of a few
+        // samples near a zero crossing doesn't read as silence
+        combEnergy = jmax(meanSquare, combEnergy * std::exp(-float(numSamples) / energyWindow));
+        sounded = true;
+    }
+    
+    envelope.render(gains.data() + startSample, numSamples);
+    envelopeLevel = envelope.getLevel();
+    
+    // a released note that has died away ends here rather than at the end
+    // of its release, and addToOutput() frees the voice. Where that is
+    // depends on the block sizes, so deterministic notes play out in full
+    if (envelope.isReleasing() && ! deterministic && std::sqrt(combEnergy) * envelopeLevel < silenceLevel)
+        envelope.reset();
+    
+    if (stealing)
+    {
+        stealGain.applyGain(gains.data() + startSample, numSamples);
+        stealFadeLeft = jmax(0, stealFadeLeft - numSamples);
+        
+        // the fade is over, so the waiting note starts on the next sample,
+        // or addToOutput() frees the voice
+        if (stealFadeLeft == 0)
+        {
+            if (pendingNote >= 0)
+                beginNote(pendingNote, true);
+            else
+                envelope.reset();
+        }
+    }
+}
+
+void SynthVoice::stopImmediately()
+{
+    envelope.reset();
+    stealing = false;
+    stealFadeLeft = 0;
+    pendingNote = -1;
+    clearCurrentNote();
+}
+
+void SynthVoice::startStealFade()
+{
+    // a note still waiting on the fade is stolen before it started
+    pendingNote = -1;
+    
+    if (stealing)
+        return;
+    
+    stealing = true;
+    stealGain.setTargetValue(0.0f);
+    stealFadeLeft = stealFadeLength;
+}
+
+float SynthVoice::getLoudness() const
+{
+    // the newest notes, which haven't sounded yet, are the last to be stolen
+    if (pendingNote >= 0 || ! sounded)
+        return std::numeric_limits<float>::max();
+    
+    if (stealing)
+        return combLevel * envelopeLevel * stealGain.getCurrentValue();
+    
+    // a held note rises to at least its sustain level
+    auto level = isPlayingButReleased() ? envelopeLevel : jmax(envelopeLevel, envelope.getParameters().sustain);
+    
+    return combLevel * level;
+}
+
+void SynthVoice::addToOutput(AudioBuffer<float> &outputBuffer, int startSample, int numSamples)
+{
+    // the envelope goes on in the same pass that sums the voice
+    for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
+        FloatVectorOperations::addWithMultiply(outputBuffer.getWritePointer(ch, startSample), combBuffer.getReadPointer(ch, startSample), gains.data() + startSample, numSamples);
+    
+    if (! envelope.isActive())
+        clearCurrentNote();
 }
@@ -4,6 +4,8 @@
 #include <JuceHeader.h>
 #include "SynthSound.h"
 #include "../audio/CombProcessor.h"
+#include "../audio/CombBatch.h"
+#include "../audio/Envelope.h"
 #include "../config.h"
 
 class SynthVoice : public SynthesiserVoice
@@ -17,16 +19,64 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock, int outputChannels);
     void reset();
     void renderNextBlock(AudioBuffer<float> &outputBuffer, int startSample, int numSamples) override;
-    void fillBuffer(AudioBuffer<float> &buffer, int numSamples);
+    // the block's input to the comb, shared with the other voices and only read
+    void setExcitation(const AudioBuffer<float>* buffer) { excitation = buffer; }
+    // every note starts from a cleared comb on its settings, with no glide
+    // or ringing carried over, so it sounds the same whatever came before.
+    // Released notes also play their whole release, not stopping once silent
+    void setDeterministic(bool shouldBeDeterministic) { deterministic = shouldBeDeterministic; }
+    
+    // the two halves of renderNextBlock, so Synth can run the first on a worker thread.
+    // Both work in place on [startSample, startSample + numSamples) of the block
+    void renderComb(int startSample, int numSamples);
+    // adds the comb's output under the envelope, one multiply-add per sample
+    void addToOutput(AudioBuffer<float> &outputBuffer, int startSample, int numSamples);
+    // renderComb() for a voice whose comb ran in a CombBatch lane, the batch's
+    // output starting at startSample
+    void renderFromBatch(const audio::CombBatch& batch, int lane, int startSample, int numSamples);
+    
+    // silences the note and frees the voice at once, for a panic
+    void stopImmediately();
+    // fades the note out over STEAL_FADE_MS and frees the voice, for Synth's voice stealing
+    void startStealFade();
+    // fading out with no note waiting to start after it
+    bool isStealFading() const { return stealing && pendingNote < 0; }
+    // a note started while the voice was still sounding waits for its fade
+    // to end, then plays from a cleared comb. Synth splits its blocks there,
+    // getPendingNoteDelay() samples on
+    bool hasPendingNote() const { return pendingNote >= 0; }
+    int getPendingNoteDelay() const { return stealFadeLeft; }
+    // how loud the voice is and is heading for, its last block's comb level
+    // under the envelope level it sustains at or releases from
+    float getLoudness() const;
     
     audio::CombProcessor& getCombProcessor() { return comb; }
-    ADSR& getADSR() { return adsr; }
+    audio::Envelope& getEnvelope() { return envelope; }
     
 private:
+    // renders the envelope and steal fade into gains, measuring the comb's level
+    void renderEnvelope(int startSample, int numSamples);
+    void beginNote(int midiNoteNumber, bool clearComb);
+    
     audio::CombProcessor comb{MAX_NUM_FILTERS};
-    ADSR adsr;
+    audio::Envelope envelope;
     
+    const AudioBuffer<float>* excitation = nullptr;
+    // the comb's output, and the gain it goes to the output under
     AudioBuffer<float> combBuffer;
+    std::vector<float> gains;
+    
+    SmoothedValue<float> stealGain;
+    int stealFadeLength = 1, stealFadeLeft = 0;
+    int pendingNote = -1;
+    float envelopeLevel = 0.0f, combLevel = 0.0f;
+    // the comb's mean square, held over SILENCE_WINDOW_MS, and the level under
+    // which a released voice is freed
+    float combEnergy = 0.0f, energyWindow = 1.0f, silenceLevel = 0.0f;
+    bool stealing = false;
+    // whether the note has rendered since it started, so combLevel is its own
+    bool sounded = false;
+    bool deterministic = false;
     
     bool isPrepared = false;
 };
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    AutomationRampTest.cpp
+    Created: 17 Oct 2026 1:51:37pm
+    Author:  Kevin Kopczynski
+
+    Checks Synth::setCombRamp() against the grid it promises. A block that
+    moves the comb's resonance, timbre, curve and spread is rendered in
+    spans split on every AUTOMATION_INTERVAL and at its MIDI event, and
+    each span's comb is set to the straight line between the two blocks'
+    values at the end of its interval, reaching the new ones exactly. The
+    values the comb processes with, getParams(), have to be on that line at
+    the end of every interval too, rather than lagging it by the comb's
+    SMOOTH_SEC smoothing. A block whose values don't change renders in one
+    span.
+
+    CMake target AutomationRampTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSynth.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    using Parameters = audio::CombProcessor::Parameters;
+    
+    // not a multiple of AUTOMATION_INTERVAL, so the last interval is short
+    constexpr int blockSize = 500;
+    constexpr int numChannels = 2;
+    // off the grid, so it splits an interval
+    constexpr int eventSample = 100;
+    
+    const Parameters before { -1.0f, RESONANCE_DEFAULT, TIMBRE_MIN, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_MIN };
+    const Parameters after { -1.0f, RESONANCE_MAX, TIMBRE_MAX, CURVE_MIN, SPREAD_MAX, GLIDE_MIN };
+    
+    struct Span
+    {
+        int start, length;
+        // what the comb was set to, and what it had processed with by the end
+        Parameters params, processed;
+    };
+    
+    // notes down every span it renders and what its comb was set to for it
+    class RecordingVoice : public SynthVoice
+    {
+    public:
+        void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+        {
+            auto active = isVoiceActive();
+            auto params = getCombProcessor().getTargetParams();
+            
+            SynthVoice::renderNextBlock(outputBuffer, startSample, numSamples);
+            
+            if (active)
+                spans.push_back({ startSample, numSamples, params, getCombProcessor().getParams() });
+        }
+        
+        std::vector<Span> spans;
+    };
+    
+    bool sameContinuous(const Parameters& a, const Parameters& b)
+    {
+        return a.resonance == b.resonance && a.timbre == b.timbre && a.curve == b.curve && a.spread == b.spread;
+    }
+    
+    // where the ramp is at the end of the interval holding startSample, as Synth works it out
+    Parameters expectedAt(int startSample)
+    {
+        auto proportion = jmin(1.0f, float((startSample / AUTOMATION_INTERVAL + 1) * AUTOMATION_INTERVAL) / float(blockSize));
+        auto params = after;
+        params.resonance = jmap(proportion, before.resonance, after.resonance);
+        params.timbre = jmap(proportion, before.timbre, after.timbre);
+        params.curve = jmap(proportion, before.curve, after.curve);
+        params.spread = jmap(proportion, before.spread, after.spread);
+        return params;
+    }
+    
+    int fail(const char* what)
+    {
+        std::printf("FAILED, %s\n", what);
+        return 1;
+    }
+}
+
+int main()
+{
+    test::SynthSetup setup;
+    setup.blockSize = blockSize;
+    setup.numChannels = numChannels;
+    setup.glide = GLIDE_MIN;
+    
+    Synth synth;
+    test::prepareSynth<RecordingVoice>(synth, setup);
+    auto* voice = dynamic_cast<RecordingVoice*>(synth.getSynthVoices().front());
+    
+    AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+    Random random(1);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int s = 0; s < blockSize; ++s)
+            excitation.setSample(ch, s, random.nextFloat() * 0.5f);
+    
+    synth.setExcitation(excitation);
+    
+    // the note starts on the first voice, with the comb still
+    MidiBuffer midi;
+    midi.addEvent(MidiMessage::noteOn(1, 60, 1.0f), 0);
+    synth.setCombRamp(before, before, blockSize);
+    synth.renderNextBlock(buffer, midi, 0, blockSize);
+    
+    // the ramp, with a second note on another voice splitting it
+    midi.clear();
+    midi.addEvent(MidiMessage::noteOn(1, 67, 1.0f), eventSample);
+    voice->spans.clear();
+    synth.setCombRamp(before, after, blockSize);
+    synth.renderNextBlock(buffer, midi, 0, blockSize);
+    
+    std::vector<int> expectedStarts;
+    for (int s = 0; s < blockSize; s += AUTOMATION_INTERVAL)
+    {
+        expectedStarts.push_back(s);
+        
+        if (eventSample > s && eventSample < s + AUTOMATION_INTERVAL)
+            expectedStarts.push_back(eventSample);
+    }
+    
+    if (voice->spans.size() != expectedStarts.size())
+        return fail("the ramp isn't split on the grid and the event");
+    
+    for (size_t i = 0; i < expectedStarts.size(); ++i)
+    {
+        const auto& span = voice->spans[i];
+        auto end = i + 1 < expectedStarts.size() ? expectedStarts[i + 1] : blockSize;
+        
+        if (span.start != expectedStarts[i] || span.start + span.length != end)
+            return fail("a span doesn't line up with the grid");
+        
+        if (! sameContinuous(span.params, expectedAt(span.start)))
+        {
+            std::printf("at sample %d resonance %g timbre %g curve %g spread %g\n", span.start, double(span.params.resonance),
+                        double(span.params.timbre), double(span.params.curve), double(span.params.spread));
+            return fail("a span's comb isn't on the ramp");
+        }
+        
+        // spans cut short by the event end mid-interval, on the way there
+        if (end % AUTOMATION_INTERVAL == 0 || end == blockSize)
+        {
+            if (! sameContinuous(span.processed, expectedAt(span.start)))
+            {
+                std::printf("at sample %d the comb processed resonance %g timbre %g curve %g spread %g\n", end, double(span.processed.resonance),
+                            double(span.processed.timbre), double(span.processed.curve), double(span.processed.spread));
+                return fail("the comb lags the ramp's grid");
+            }
+        }
+    }
+    
+    if (! sameContinuous(voice->spans.back().params, after))
+        return fail("the ramp doesn't end on the new values");
+    
+    // nothing changes, so one span on the new values
+    midi.clear();
+    voice->spans.clear();
+    synth.setCombRamp(after, after, blockSize);
+    synth.renderNextBlock(buffer, midi, 0, blockSize);
+    
+    if (voice->spans.size() != 1 || voice->spans[0].start != 0 || voice->spans[0].length != blockSize)
+        return fail("an unchanged block is split");
+    
+    if (! sameContinuous(voice->spans[0].params, after) || ! sameContinuous(voice->spans[0].processed, after))
+        return fail("an unchanged block moves the comb");
+    
+    std::printf("ok, %d spans on the ramp, one without it\n", int(expectedStarts.size()));
+    return 0;
+}
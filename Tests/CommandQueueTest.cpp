@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    CommandQueueTest.cpp
+    Created: 17 Oct 2026 12:49:29pm
+    Author:  Kevin Kopczynski
+
+    Checks CommandQueue on its own, then hammers it from a second thread
+    with panics, all-notes-offs and state restores while the main thread
+    renders a synth on two worker threads, draining the queue at the top of
+    every block the way PluginProcessor::processBlock() does. Every
+    all-notes-off has to arrive once, a panic or restore at least once
+    after the last one sent and never more often than sent, and a panic
+    has to leave no voice playing.
+
+    CMake target CommandQueueTest, run by ctest. Returns non-zero on failure.
+    Configured with FINETOOTH_TSAN, ctest runs it under ThreadSanitizer,
+    and any data race fails it.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSynth.h"
+#include "../Source/synth/CommandQueue.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    using Type = CommandQueue::Command::Type;
+    
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    constexpr int numChannels = 2;
+    constexpr int numVoices = 8;
+    constexpr int numCommands = 20000;
+    constexpr Type sequence[] = { Type::Panic, Type::AllNotesOff, Type::StateRestored };
+    
+    int checkQueue()
+    {
+        CommandQueue queue;
+        CommandQueue::Command command;
+        int numFailures = 0;
+        
+        if (queue.pop(command))
+            ++numFailures;
+        
+        // fill it and overflow it, which a panic and a restore still get
+        // into, twice each but out once, a panic first
+        for (uint32 i = 0; i < CommandQueue::capacity; ++i)
+            if (! queue.push({ Type::AllNotesOff }))
+                ++numFailures;
+        
+        if (queue.push({ Type::AllNotesOff }))
+            ++numFailures;
+        
+        for (auto type : { Type::StateRestored, Type::Panic, Type::StateRestored, Type::Panic })
+            if (! queue.push({ type }))
+                ++numFailures;
+        
+        for (auto type : { Type::Panic, Type::StateRestored, Type::AllNotesOff })
+            if (! queue.pop(command) || command.type != type)
+                ++numFailures;
+        
+        // then wrap the counts around a few times
+        for (uint32 i = 1; i < 5 * CommandQueue::capacity; ++i)
+        {
+            if (! queue.pop(command) || command.type != Type::AllNotesOff)
+                ++numFailures;
+            
+            queue.push({ Type::AllNotesOff });
+        }
+        
+        std::printf("%-10s %s\n", "queue", numFailures == 0 ? "ok" : "FAILED");
+        return numFailures;
+    }
+    
+    int checkStress()
+    {
+        test::SynthSetup setup;
+        setup.sampleRate = sampleRate;
+        setup.blockSize = blockSize;
+        setup.numChannels = numChannels;
+        setup.numVoices = numVoices;
+        setup.polyphony = numVoices - NUM_STEAL_VOICES;
+        setup.numRenderThreads = 2;
+        setup.multirate = true;
+        
+        Synth synth;
+        test::prepareSynth(synth, setup);
+        
+        CommandQueue queue;
+        std::atomic<bool> sent { false };
+        
+        // the message thread, retrying while the audio thread catches up
+        std::thread producer([&]
+        {
+            for (int i = 0; i < numCommands; ++i)
+                while (! queue.push({ sequence[i % 3] }))
+                    std::this_thread::yield();
+            
+            sent = true;
+        });
+        
+        AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        int numSent[3] {}, numReceived[3] {};
+        int numFailures = 0, block = 0;
+        bool finite = true;
+        
+        for (int i = 0; i < numCommands; ++i)
+            ++numSent[int(sequence[i % 3])];
+        
+        for (;;)
+        {
+            // everything pushed before this is popped below
+            auto done = sent.load();
+            CommandQueue::Command command;
+            
+            while (queue.pop(command))
+            {
+                ++numReceived[int(command.type)];
+                
+                if (command.type == Type::Panic)
+                {
+                    synth.stopAllVoices();
+                    
+                    if (synth.isPlaying())
+                        ++numFailures;
+                }
+                else if (command.type == Type::AllNotesOff)
+                {
+                    synth.allNotesOff(0, true);
+                }
+            }
+            
+            if (done)
+                break;
+            
+            // a chord every few blocks, so there is always something to stop
+            MidiBuffer midi;
+            if (block % 4 == 0)
+                for (int n = 0; n < 3; ++n)
+                    midi.addEvent(MidiMessage::noteOn(1, 48 + 7 * n + block % 12, 1.0f), (n * 17) % blockSize);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    excitation.setSample(ch, s, random.nextFloat() * 0.5f - 0.25f);
+            
+            buffer.clear();
+            synth.setExcitation(excitation);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            
+            for (int s = 0; s < blockSize; ++s)
+                finite = finite && std::isfinite(buffer.getSample(0, s));
+            
+            ++block;
+        }
+        
+        producer.join();
+        
+        for (auto type : { Type::Panic, Type::StateRestored })
+            if (numReceived[int(type)] < 1 || numReceived[int(type)] > numSent[int(type)])
+                ++numFailures;
+        
+        if (numReceived[int(Type::AllNotesOff)] != numSent[int(Type::AllNotesOff)] || ! finite)
+            ++numFailures;
+        
+        std::printf("%-10s %s, %d panics, %d all-notes-offs and %d restores over %d blocks\n", "stress", numFailures == 0 ? "ok" : "FAILED",
+                    numReceived[int(Type::Panic)], numReceived[int(Type::AllNotesOff)], numReceived[int(Type::StateRestored)], block);
+        return numFailures;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += checkQueue();
+    numFailures += checkStress();
+    
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    DeterministicRenderTest.cpp
+    Created: 17 Oct 2026 12:31:36pm
+    Author:  Kevin Kopczynski
+
+    Checks that with Deterministic on, a stretch of the timeline renders to
+    the same samples every time. The excitation and voices are driven the
+    way PluginProcessor::processBlock() drives them, with the noise on
+    stream 0 and moved to the timeline position every block. A phrase is
+    rendered from the start as the reference, then again by the same synth,
+    and from a later start point by a new synth and by the used one. The
+    later start point falls between notes but not on a block boundary of
+    the reference, and past the noise's first colour segment. Every colour
+    on the plain, threaded and batched render paths.
+
+    CMake target DeterministicRenderTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSynth.h"
+#include "../Source/audio/NoiseGenerator.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using audio::NoiseGenerator;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numVoices = 6;
+    constexpr int totalLength = 6 * 48000;
+    // between two notes, with the first one's release long over
+    constexpr int laterStart = 4 * 48000 + 24071;
+    
+    struct Note
+    {
+        int onset, offset, note;
+    };
+    
+    // overlapping chords before and after the later start point, none
+    // sounding across it
+    const std::vector<Note> notes {
+        { 1000, 30000, 48 }, { 9000, 40000, 55 }, { 17000, 52000, 64 }, { 60000, 90000, 60 },
+        { 150000, 190000, 43 }, { 190000, 205000, 67 }, { 170000, 200000, 72 },
+        { 220000, 250000, 50 }, { 221234, 260000, 57 }, { 235000, 265000, 62 }, { 262000, 275000, 69 }
+    };
+    
+    struct Renderer
+    {
+        Renderer(NoiseGenerator::Colour colour, int numRenderThreads, bool voiceBatching)
+        {
+            test::SynthSetup setup;
+            setup.sampleRate = sampleRate;
+            setup.blockSize = blockSize;
+            setup.numChannels = numChannels;
+            setup.numVoices = numVoices;
+            setup.polyphony = numVoices - NUM_STEAL_VOICES;
+            setup.numRenderThreads = numRenderThreads;
+            setup.voiceBatching = voiceBatching;
+            setup.multirate = ! voiceBatching;
+            setup.deterministic = true;
+            setup.envelope = audio::Envelope::Parameters(0.005f, 0.1f, 0.7f, 0.2f);
+            test::prepareSynth(synth, setup);
+            
+            noise.prepare(sampleRate);
+            noise.setStream(0);
+            noise.setColour(colour);
+            excitation.setSize(numChannels, blockSize);
+        }
+        
+        // the output from sample start of the timeline to the end
+        std::vector<float> render(int start)
+        {
+            std::vector<float> output;
+            AudioBuffer<float> buffer(numChannels, blockSize);
+            
+            for (int pos = start; pos < totalLength; pos += blockSize)
+            {
+                auto numSamples = jmin(blockSize, totalLength - pos);
+                MidiBuffer midi;
+                
+                for (auto& note : notes)
+                {
+                    if (note.onset >= pos && note.onset < pos + numSamples)
+                        midi.addEvent(MidiMessage::noteOn(1, note.note, 1.0f), note.onset - pos);
+                    if (note.offset >= pos && note.offset < pos + numSamples)
+                        midi.addEvent(MidiMessage::noteOff(1, note.note), note.offset - pos);
+                }
+                
+                noise.setPosition(uint64(pos));
+                noise.process(excitation.getArrayOfWritePointers(), numChannels, numSamples);
+                
+                buffer.clear();
+                synth.setExcitation(excitation);
+                synth.renderNextBlock(buffer, midi, 0, numSamples);
+                
+                for (int s = 0; s < numSamples; ++s)
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        output.push_back(buffer.getSample(ch, s));
+            }
+            
+            return output;
+        }
+        
+        Synth synth;
+        NoiseGenerator noise;
+        AudioBuffer<float> excitation;
+    };
+    
+    // the first sample where output differs from the reference's tail, or -1
+    int firstDifference(const std::vector<float>& reference, const std::vector<float>& output)
+    {
+        auto offset = reference.size() - output.size();
+        
+        for (size_t i = 0; i < output.size(); ++i)
+            if (output[i] != reference[offset + i])
+                return int((offset + i) / numChannels);
+        
+        return -1;
+    }
+    
+    int check(const char* name, NoiseGenerator::Colour colour, int numRenderThreads, bool voiceBatching)
+    {
+        Renderer used(colour, numRenderThreads, voiceBatching), fresh(colour, numRenderThreads, voiceBatching);
+        auto reference = used.render(0);
+        
+        struct Run
+        {
+            const char* what;
+            std::vector<float> output;
+        };
+        
+        Run runs[] = {
+            { "again", used.render(0) },
+            { "later start", fresh.render(laterStart) },
+            { "later start again", used.render(laterStart) }
+        };
+        
+        int numFailures = 0;
+        
+        for (auto& run : runs)
+        {
+            auto difference = firstDifference(reference, run.output);
+            
+            if (difference >= 0)
+            {
+                std::printf("%s: %s differs from sample %d\n", name, run.what, difference);
+                ++numFailures;
+            }
+        }
+        
+        std::printf("%-16s %s\n", name, numFailures == 0 ? "ok" : "FAILED");
+        return numFailures;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += check("white plain", NoiseGenerator::Colour::White, 0, false);
+    numFailures += check("pink plain", NoiseGenerator::Colour::Pink, 0, false);
+    numFailures += check("brown plain", NoiseGenerator::Colour::Brown, 0, false);
+    numFailures += check("white threaded", NoiseGenerator::Colour::White, 2, false);
+    numFailures += check("pink threaded", NoiseGenerator::Colour::Pink, 2, false);
+    numFailures += check("white batched", NoiseGenerator::Colour::White, 0, true);
+    numFailures += check("pink batched", NoiseGenerator::Colour::Pink, 0, true);
+    
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    EnvelopeTest.cpp
+    Created: 17 Oct 2026 1:53:05pm
+    Author:  Kevin Kopczynski
+
+    Checks audio::Envelope three ways. Linear, it follows juce::ADSR sample
+    by sample through attack, decay, sustain, release and a retrigger
+    mid-release, to within a sample's step either way as segment lengths
+    are rounded to whole samples, and the rounding ADSR's own running sum
+    piles up. Exponential, every segment lands exactly
+    on its target on its last sample. And setParameters() during attack,
+    decay and release carries on from the current level without a jump and
+    reaches the new target when the documented timing says it will, for
+    both shapes. Every render is split into uneven blocks, so segments end
+    anywhere in a block.
+
+    CMake target EnvelopeTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/audio/Envelope.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr float tolerance = 1.0e-5f;
+    // ADSR adds its rate to its level every sample, rounding each time by
+    // up to half a float's epsilon at levels below 1
+    constexpr float adsrDriftPerSample = 0.5f * std::numeric_limits<float>::epsilon();
+    
+    using Shape = Envelope::Shape;
+    
+    // the next numSamples of the envelope, in blocks of 1 to 97 samples
+    std::vector<float> render(Envelope& envelope, int numSamples)
+    {
+        auto levels = std::vector<float>(size_t(numSamples));
+        
+        for (int done = 0, block = 1; done < numSamples; block = block % 97 + 13)
+        {
+            auto num = jmin(block, numSamples - done);
+            envelope.render(levels.data() + done, num);
+            done += num;
+        }
+        
+        return levels;
+    }
+    
+    std::vector<float> render(ADSR& adsr, int numSamples)
+    {
+        auto levels = std::vector<float>(size_t(numSamples));
+        
+        for (auto& level : levels)
+            level = adsr.getNextSample();
+        
+        return levels;
+    }
+    
+    int samplesOf(float seconds) { return roundToInt(double(seconds) * sampleRate); }
+    
+    int fail(const char* test, const char* what, int sample)
+    {
+        std::printf("%-18s FAILED, %s at sample %d\n", test, what, sample);
+        return 1;
+    }
+    
+    // a note held through its decay into sustain, released, retriggered
+    // halfway through the release and released again, against ADSR
+    int checkLinear(const Envelope::Parameters& parameters)
+    {
+        Envelope envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(parameters);
+        
+        ADSR adsr;
+        adsr.setSampleRate(sampleRate);
+        adsr.setParameters({ parameters.attack, parameters.decay, parameters.sustain, parameters.release });
+        
+        // rounding a segment's length moves its end by up to a sample, so
+        // the two are at most a step apart, and ADSR's level drifts from
+        // the noteOn() or noteOff() before
+        auto maxStep = jmax(1.0f / float(samplesOf(parameters.attack)), (1.0f - parameters.sustain) / float(samplesOf(parameters.decay)),
+                            1.0f / float(samplesOf(parameters.release)));
+        
+        auto held = samplesOf(parameters.attack + parameters.decay) + 1000;
+        auto releasing = samplesOf(parameters.release) / 2;
+        auto tail = samplesOf(parameters.attack + parameters.decay + parameters.release) + 1000;
+        
+        std::vector<float> ours, theirs;
+        std::vector<int> events;
+        auto append = [] (std::vector<float>& to, const std::vector<float>& from) { to.insert(to.end(), from.begin(), from.end()); };
+        
+        events.push_back(0);
+        envelope.noteOn();
+        adsr.noteOn();
+        append(ours, render(envelope, held));
+        append(theirs, render(adsr, held));
+        
+        events.push_back(int(ours.size()));
+        envelope.noteOff();
+        adsr.noteOff();
+        append(ours, render(envelope, releasing));
+        append(theirs, render(adsr, releasing));
+        
+        events.push_back(int(ours.size()));
+        envelope.noteOn();
+        adsr.noteOn();
+        append(ours, render(envelope, held));
+        append(theirs, render(adsr, held));
+        
+        events.push_back(int(ours.size()));
+        envelope.noteOff();
+        adsr.noteOff();
+        append(ours, render(envelope, tail));
+        append(theirs, render(adsr, tail));
+        
+        float maxDifference = 0.0f;
+        
+        for (int s = 0, event = 0; s < int(ours.size()); ++s)
+        {
+            if (event + 1 < int(events.size()) && s >= events[size_t(event + 1)])
+                ++event;
+            
+            auto difference = std::abs(ours[size_t(s)] - theirs[size_t(s)]);
+            maxDifference = jmax(maxDifference, difference);
+            
+            if (difference > maxStep + adsrDriftPerSample * float(s - events[size_t(event)]) + tolerance)
+                return fail("linear vs ADSR", "the levels differ by more than a step", s);
+        }
+        
+        if (envelope.isActive() || adsr.isActive())
+            return fail("linear vs ADSR", "the release doesn't end", int(ours.size()));
+        
+        std::printf("%-18s ok, %g %g %g %g, max difference %.2g, a step %.2g\n", "linear vs ADSR", double(parameters.attack),
+                    double(parameters.decay), double(parameters.sustain), double(parameters.release), double(maxDifference), double(maxStep));
+        return 0;
+    }
+    
+    int checkExponentialTargets()
+    {
+        const Envelope::Parameters parameters(0.01f, 0.05f, 0.4f, 0.1f, Shape::Exponential);
+        
+        Envelope envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(parameters);
+        
+        auto attack = samplesOf(parameters.attack);
+        auto decay = samplesOf(parameters.decay);
+        auto release = samplesOf(parameters.release);
+        
+        envelope.noteOn();
+        auto held = render(envelope, attack + decay + 1000);
+        envelope.noteOff();
+        auto released = render(envelope, release + 100);
+        
+        for (int s = 0; s < attack - 1; ++s)
+            if (held[size_t(s)] >= 1.0f || held[size_t(s + 1)] <= held[size_t(s)])
+                return fail("exponential", "the attack doesn't rise to 1", s);
+        
+        if (held[size_t(attack - 1)] != 1.0f)
+            return fail("exponential", "the attack doesn't end on 1", attack - 1);
+        
+        for (int s = attack; s < attack + decay - 1; ++s)
+            if (held[size_t(s)] <= parameters.sustain || held[size_t(s + 1)] >= held[size_t(s)])
+                return fail("exponential", "the decay doesn't fall to sustain", s);
+        
+        for (int s = attack + decay - 1; s < int(held.size()); ++s)
+            if (held[size_t(s)] != parameters.sustain)
+                return fail("exponential", "the decay doesn't end on sustain", s);
+        
+        for (int s = 0; s < release - 1; ++s)
+            if (released[size_t(s)] <= 0.0f)
+                return fail("exponential", "the release ends early", s);
+        
+        for (int s = release - 1; s < int(released.size()); ++s)
+            if (released[size_t(s)] != 0.0f)
+                return fail("exponential", "the release doesn't end on 0", s);
+        
+        if (envelope.isActive())
+            return fail("exponential", "the release doesn't end", int(released.size()));
+        
+        std::printf("%-18s ok, every segment ends on its target\n", "exponential");
+        return 0;
+    }
+    
+    enum class During
+    {
+        attack,
+        decay,
+        release
+    };
+    
+    // new parameters partway through a segment, which has to carry on from
+    // the level it was at and reach its target after the samples the
+    // remaining distance takes at the new rate
+    int checkChange(During during, Shape shape)
+    {
+        const char* names[] = { "attack", "decay", "release" };
+        char test[32];
+        std::snprintf(test, sizeof(test), "change %s %s", shape == Shape::Linear ? "lin" : "exp", names[int(during)]);
+        
+        const Envelope::Parameters parameters(0.02f, 0.04f, 0.5f, 0.08f, shape);
+        const Envelope::Parameters changed(0.05f, 0.01f, 0.2f, 0.03f, shape);
+        
+        Envelope envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(parameters);
+        envelope.noteOn();
+        
+        int before = 0;
+        float releaseLevel = 0.0f;
+        
+        switch (during)
+        {
+            case During::attack:
+                before = samplesOf(parameters.attack) / 3;
+                break;
+            case During::decay:
+                before = samplesOf(parameters.attack) + samplesOf(parameters.decay) / 3;
+                break;
+            case During::release:
+                render(envelope, samplesOf(parameters.attack + parameters.decay) + 100);
+                releaseLevel = envelope.getLevel();
+                envelope.noteOff();
+                before = samplesOf(parameters.release) / 3;
+                break;
+        }
+        
+        render(envelope, before);
+        auto level = envelope.getLevel();
+        envelope.setParameters(changed);
+        
+        float target = 0.0f;
+        int remaining = 0;
+        
+        switch (during)
+        {
+            case During::attack:
+                target = 1.0f;
+                remaining = roundToInt(double(changed.attack) * double(1.0f - level) * sampleRate);
+                break;
+            case During::decay:
+                // the full decay time is from 1 to the new sustain level
+                target = changed.sustain;
+                remaining = roundToInt(double(changed.decay) * double((level - target) / (1.0f - target)) * sampleRate);
+                break;
+            case During::release:
+                target = 0.0f;
+                remaining = roundToInt(double(changed.release) * double(level / releaseLevel) * sampleRate);
+                break;
+        }
+        
+        auto after = render(envelope, remaining + 100);
+        
+        // the largest step a ramp of remaining samples takes, its first for
+        // an exponential one
+        auto distance = std::abs(target - level);
+        auto maxStep = shape == Shape::Linear ? distance / float(remaining)
+                                              : distance * Envelope::exponentialCurvature / (float(remaining) * (1.0f - std::exp(-Envelope::exponentialCurvature)));
+        
+        if (std::abs(after[0] - level) > maxStep * 1.01f + tolerance)
+            return fail(test, "the level jumps", 0);
+        
+        for (int s = 0; s < remaining - 1; ++s)
+            if (after[size_t(s)] == target)
+                return fail(test, "the new target comes early", s);
+        
+        // after the attack the decay starts, the others hold their target
+        auto holdsUntil = during == During::attack ? remaining : int(after.size());
+        
+        for (int s = remaining - 1; s < holdsUntil; ++s)
+            if (after[size_t(s)] != target)
+                return fail(test, "the new target isn't reached on time", s);
+        
+        std::printf("%-18s ok, from %.3f to %.3f in %d samples\n", test, double(level), double(target), remaining);
+        return 0;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += checkLinear({ 0.01f, 0.05f, 0.6f, 0.1f });
+    numFailures += checkLinear({ 0.0013f, 0.0071f, 0.25f, 0.0337f });
+    numFailures += checkLinear({ 0.2f, 0.3f, 0.9f, 0.5f });
+    numFailures += checkExponentialTargets();
+    
+    for (auto shape : { Shape::Linear, Shape::Exponential })
+        for (auto during : { During::attack, During::decay, During::release })
+            numFailures += checkChange(during, shape);
+    
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    FastMathTest.cpp
+    Created: 17 Oct 2026 1:37:44pm
+    Author:  Kevin Kopczynski
+
+    Checks the largest error of every fastmath function over the domain
+    FastMath.h gives for it, against the double precision std:: function at
+    the same float inputs, and holds each to the bound documented there.
+    Errors are printed in the unit that matters where they're used: cents
+    for exp2, log2, tanPrewarp's cutoff and midiToFreq, dB for dbToGain.
+
+    CMake target FastMathTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/config.h"
+#include "../Source/audio/FastMath.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr int numPoints = 1 << 20;
+    
+    // point i of numPoints from one end of a domain to the other, evenly
+    // spaced or evenly spaced in log
+    double linear(double from, double to, int i) { return from + (to - from) * double(i) / double(numPoints - 1); }
+    double logarithmic(double from, double to, int i) { return from * std::pow(to / from, double(i) / double(numPoints - 1)); }
+    
+    double ratioToCents(double ratio) { return std::abs(1200.0 * std::log2(ratio)); }
+    
+    int check(const char* name, double maxError, double limit, const char* unit)
+    {
+        auto ok = maxError <= limit;
+        std::printf("%-12s %-6s max %.3g %s, limit %.3g\n", name, ok ? "ok" : "FAILED", maxError, unit, limit);
+        return ok ? 0 : 1;
+    }
+    
+    int checkExp2()
+    {
+        double maxCents = 0.0;
+        
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto x = float(linear(-126.0, 126.0, i));
+            maxCents = jmax(maxCents, ratioToCents(double(fastmath::exp2(x)) / std::exp2(double(x))));
+        }
+        
+        return check("exp2", maxCents, 0.0002, "cents");
+    }
+    
+    int checkLog2()
+    {
+        // absolute within an octave of 1 and relative beyond it, as in
+        // FastMath.h, in cents of the octave count
+        double maxCents = 0.0;
+        
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto x = float(logarithmic(1.0e-30, 1.0e30, i));
+            auto exact = std::log2(double(x));
+            auto error = std::abs(double(fastmath::log2(x)) - exact) / jmax(1.0, std::abs(exact));
+            maxCents = jmax(maxCents, 1200.0 * error);
+        }
+        
+        return check("log2", maxCents, 1200.0 * 4.3e-7, "cents");
+    }
+    
+    int checkPow()
+    {
+        double maxError = 0.0;
+        
+        for (int i = 0; i < 1024; ++i)
+        {
+            auto x = float(logarithmic(0.01, 1000.0, i * (numPoints / 1024)));
+            
+            for (int j = 0; j < 1024; ++j)
+            {
+                auto y = float(linear(-3.0, 3.0, j * (numPoints / 1024)));
+                auto exact = std::pow(double(x), double(y));
+                maxError = jmax(maxError, std::abs(double(fastmath::pow(x, y)) - exact) / exact);
+            }
+        }
+        
+        return check("pow", maxError, 2.4e-6, "rel");
+    }
+    
+    int checkDbToGain()
+    {
+        double maxDb = 0.0;
+        
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto db = float(linear(-600.0, 600.0, i));
+            auto exact = std::pow(10.0, double(db) / 20.0);
+            maxDb = jmax(maxDb, std::abs(20.0 * std::log10(double(fastmath::dbToGain(db)) / exact)));
+        }
+        
+        return check("dbToGain", maxDb, 0.00003, "dB");
+    }
+    
+    int checkTanPrewarp()
+    {
+        // how far the cutoff the coefficient tunes the filter to is from w
+        double maxCents = 0.0;
+        
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto w = float(logarithmic(1.0e-6, 0.499, i));
+            auto tunedTo = std::atan(double(fastmath::tanPrewarp(w))) / MathConstants<double>::pi;
+            maxCents = jmax(maxCents, ratioToCents(tunedTo / double(w)));
+        }
+        
+        return check("tanPrewarp", maxCents, 0.0004, "cents");
+    }
+    
+    int checkMidiToFreq()
+    {
+        double maxCents = 0.0;
+        
+        for (int note = 0; note < 128; ++note)
+        {
+            auto exact = 440.0 * std::exp2((note - 69) / 12.0);
+            maxCents = jmax(maxCents, ratioToCents(double(midiToFreq(note)) / exact));
+        }
+        
+        if (midiToFreq(69) != 440.0f)
+        {
+            std::printf("%-12s FAILED, note 69 is %.9g Hz\n", "midiToFreq", double(midiToFreq(69)));
+            return 1;
+        }
+        
+        return check("midiToFreq", maxCents, 0.0004, "cents");
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += checkExp2();
+    numFailures += checkLog2();
+    numFailures += checkPow();
+    numFailures += checkDbToGain();
+    numFailures += checkTanPrewarp();
+    numFailures += checkMidiToFreq();
+    
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    FusedFilterTest.cpp
+    Created: 17 Oct 2026 2:19:40pm
+    Author:  Kevin Kopczynski
+
+    Checks FilterBank's fused pass against test::PartialChain, the per
+    partial dsp::StateVariableTPTFilter chain it replaced, over the range of
+    every comb parameter that reaches it: harmonics from one to
+    MAX_NUM_FILTERS, fundamentals low and high, resonance, timbre and curve
+    at their minimum, default and maximum, with the per-harmonic Q, timbre
+    and curve gains CombProcessor works out. Full-scale noise goes through
+    both from cleared state, and the largest difference between their
+    outputs has to stay under maxDifference of the chain's peak, the bound
+    FilterBank's comment states. At the highest Qs, thousands for the upper
+    harmonics at full resonance, float rounding in the recursion is the
+    limit: the chain itself is only within about -78 dB of the same filters
+    in double, and the bank within about -74 dB.
+
+    CMake target FusedFilterTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PartialChain.h"
+#include "../Source/audio/FilterBank.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace audio;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numBlocks = 16;
+    // against the chain's peak output, -70 dB
+    constexpr double maxDifference = 3.2e-4;
+    
+    // the partials of a comb at these settings, up to Nyquist
+    test::Partials makePartials(float fundamental, int numHarmonics, float resonance, float timbre, float curve)
+    {
+        test::Partials partials;
+        
+        for (int i = 0; i < numHarmonics && fundamental * float(i + 1) < float(sampleRate) * 0.5f; ++i)
+        {
+            partials.cutoffs.push_back(fundamental * float(i + 1));
+            partials.resonances.push_back(resonance * (float(i) / 2.0f + 1.0f));
+            partials.timbreGains.push_back(i == 0 ? 1.0f : i % 2 == 1 ? 1.0f - timbre : timbre);
+            partials.curveGains.push_back(curve * float(i) > -100.0f ? Decibels::decibelsToGain(curve * float(i)) : 0.0f);
+        }
+        
+        return partials;
+    }
+    
+    // the largest difference between the two, over the chain's peak
+    double compare(const test::Partials& partials)
+    {
+        test::PartialChain chain(partials, sampleRate, numChannels, blockSize);
+        auto gains = partials.getGains();
+        
+        FilterBank bank;
+        bank.prepare(sampleRate, partials.size());
+        bank.setCullThreshold(-1000.0f);
+        bank.setCoefficients(partials.cutoffs.data(), partials.resonances.data(), partials.size());
+        bank.setGains(gains.data(), partials.size());
+        
+        AudioBuffer<float> noise(numChannels, blockSize), chainOut(numChannels, blockSize), fusedOut(numChannels, blockSize);
+        Random random(1);
+        double peak = 0.0, difference = 0.0;
+        
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    noise.setSample(ch, s, random.nextFloat() * 2.0f - 1.0f);
+            
+            chain.process(noise, chainOut, blockSize);
+            bank.process(noise.getArrayOfReadPointers(), fusedOut.getArrayOfWritePointers(), numChannels, blockSize);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    peak = jmax(peak, std::abs(double(chainOut.getSample(ch, s))));
+                    difference = jmax(difference, std::abs(double(chainOut.getSample(ch, s)) - double(fusedOut.getSample(ch, s))));
+                }
+            }
+        }
+        
+        return difference / jmax(peak, 1.0e-30);
+    }
+}
+
+int main()
+{
+    int numFailures = 0, numChecked = 0;
+    double worst = 0.0;
+    
+    for (auto fundamental : { 27.5f, 440.0f, 3520.0f })
+    {
+        for (auto numHarmonics : { HARMONICS_MIN, HARMONICS_DEFAULT, HARMONICS_MAX })
+        {
+            for (auto resonance : { RESONANCE_MIN, RESONANCE_DEFAULT, RESONANCE_MAX })
+            {
+                for (auto timbre : { TIMBRE_MIN, TIMBRE_DEFAULT, TIMBRE_MAX })
+                {
+                    for (auto curve : { CURVE_MIN, CURVE_DEFAULT, CURVE_MAX })
+                    {
+                        auto difference = compare(makePartials(fundamental, numHarmonics, resonance, timbre, curve));
+                        worst = jmax(worst, difference);
+                        ++numChecked;
+                        
+                        if (difference > maxDifference)
+                        {
+                            std::printf("FAILED at %g Hz, %d harmonics, resonance %g, timbre %g, curve %g: %.1f dB\n", double(fundamental), numHarmonics,
+                                        double(resonance), double(timbre), double(curve), Decibels::gainToDecibels(difference, -200.0));
+                            ++numFailures;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    std::printf("%d of %d settings within %.0f dB, the worst %.1f dB\n", numChecked - numFailures, numChecked,
+                Decibels::gainToDecibels(maxDifference), Decibels::gainToDecibels(worst, -200.0));
+    
+    return numFailures == 0 ? 0 : 1;
+}
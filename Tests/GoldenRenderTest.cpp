@@ -0,0 +1,500 @@
+/*
+  ==============================================================================
+
+    GoldenRenderTest.cpp
+    Created: 17 Oct 2026 1:17:15pm
+    Author:  Kevin Kopczynski
+
+    Renders a fixed set of CombProcessor scenarios and compares them with
+    the reference renders in Tests/golden, so a faster or approximated
+    engine is accepted only if it still sounds the same. The scenarios
+    cover notes across the keyboard, every FreqOutOfBoundsMode, the ends
+    of the resonance, spread, curve and timbre ranges, glides up and down,
+    each engine, and seeded Noise and Ext inputs.
+
+    Each render is compared twice. In the sample domain, the RMS of the
+    difference relative to the reference's RMS must stay under the
+    scenario's sampleDb. In the spectral domain, the level of every sixth
+    of an octave must stay within spectralDb of the reference's, over the
+    bands within spectralFloorDb of the reference's loudest. The first
+    catches any change in the waveform, the second lets a change through
+    only if it is too small to alter the spectrum.
+
+    The combs run at the full rate, without the subband filters, whose
+    coefficients come from JUCE's filter design and would tie the
+    references to a JUCE version. The Ext input is a seeded mix of clicks,
+    a chirp and hash noise, built here so it doesn't depend on JUCE either.
+
+        GoldenRenderTest [--golden dir] [--update] [--only name]
+
+    --update writes the current renders as the new references, after a
+    change that is meant to alter the sound. The references are 32-bit
+    float WAVs, to be listened to or diffed in any editor.
+
+    CMake target GoldenRenderTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/audio/CombProcessor.h"
+#include "../Source/audio/NoiseGenerator.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace audio;
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 256;
+    constexpr int renderLength = 8192;
+    constexpr int fftSize = 1024;
+    
+    enum class Input
+    {
+        White,
+        Pink,
+        Brown,
+        Ext
+    };
+    
+    struct Scenario
+    {
+        const char* name;
+        double sampleRate = 48000.0;
+        int note = 60;
+        // the note glided to from renderLength / 4, or the same note
+        int glideNote = -1;
+        float resonance = RESONANCE_DEFAULT, timbre = TIMBRE_DEFAULT, curve = CURVE_DEFAULT, spread = SPREAD_DEFAULT;
+        float glide = GLIDE_MIN;
+        CombProcessor::FreqOutOfBoundsMode mode = CombProcessor::FreqOutOfBoundsMode::Ignore;
+        int harmonics = HARMONICS_DEFAULT;
+        CombProcessor::Engine engine = CombProcessor::Engine::SVF;
+        Input input = Input::White;
+        uint32 seed = 1;
+        // the largest error allowed in each domain
+        float sampleDb = -40.0f, spectralDb = 0.5f;
+        float spectralFloorDb = -60.0f;
+    };
+    
+    using Mode = CombProcessor::FreqOutOfBoundsMode;
+    using Engine = CombProcessor::Engine;
+    
+    std::vector<Scenario> makeScenarios()
+    {
+        std::vector<Scenario> scenarios;
+        auto add = [&] (const char* name, auto&& set)
+        {
+            Scenario scenario;
+            scenario.name = name;
+            set(scenario);
+            scenarios.push_back(scenario);
+        };
+        
+        add("note_low",         [] (Scenario& s) { s.note = 28; });
+        add("note_mid",         [] (Scenario& s) { s.note = 60; });
+        add("note_high",        [] (Scenario& s) { s.note = 96; });
+        add("note_high_96k",    [] (Scenario& s) { s.note = 96; s.sampleRate = 96000.0; });
+        // the top harmonics of these pass Nyquist, so they differ by mode.
+        // Every partial near Nyquist is sensitive to its coefficients, so
+        // the sample domain is looser
+        add("mode_ignore",      [] (Scenario& s) { s.note = 84; s.harmonics = 64; s.mode = Mode::Ignore; });
+        add("mode_wrap",        [] (Scenario& s) { s.note = 84; s.harmonics = 64; s.mode = Mode::Wrap; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        add("mode_fold",        [] (Scenario& s) { s.note = 84; s.harmonics = 64; s.mode = Mode::Fold; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        add("harmonics_max",    [] (Scenario& s) { s.note = 36; s.harmonics = HARMONICS_MAX; s.mode = Mode::Fold; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        // the narrowest partials ring longest, so phase errors build up most there
+        add("resonance_min",    [] (Scenario& s) { s.resonance = RESONANCE_MIN; });
+        add("resonance_max",    [] (Scenario& s) { s.resonance = RESONANCE_MAX; s.sampleDb = -30.0f; });
+        add("spread_min",       [] (Scenario& s) { s.spread = SPREAD_MIN; });
+        add("spread_max",       [] (Scenario& s) { s.spread = SPREAD_MAX; s.mode = Mode::Fold; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        add("curve_min",        [] (Scenario& s) { s.curve = CURVE_MIN; s.spectralFloorDb = -50.0f; });
+        add("curve_max",        [] (Scenario& s) { s.curve = CURVE_MAX; });
+        add("timbre_min",       [] (Scenario& s) { s.timbre = TIMBRE_MIN; });
+        add("timbre_max",       [] (Scenario& s) { s.timbre = TIMBRE_MAX; });
+        // the partials sweep through the FFT frames, so the bands are looser
+        add("glide_up",         [] (Scenario& s) { s.note = 36; s.glideNote = 72; s.glide = 0.1f; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        add("glide_down",       [] (Scenario& s) { s.note = 84; s.glideNote = 48; s.glide = 0.1f; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        add("engine_modal",     [] (Scenario& s) { s.engine = Engine::Modal; });
+        add("engine_waveguide", [] (Scenario& s) { s.engine = Engine::Waveguide; });
+        add("noise_pink",       [] (Scenario& s) { s.input = Input::Pink; s.seed = 2; });
+        add("noise_brown",      [] (Scenario& s) { s.input = Input::Brown; s.seed = 3; s.spectralFloorDb = -50.0f; });
+        add("ext_mid",          [] (Scenario& s) { s.input = Input::Ext; s.seed = 4; });
+        add("ext_high_fold",    [] (Scenario& s) { s.input = Input::Ext; s.seed = 5; s.note = 90; s.mode = Mode::Fold; s.sampleDb = -30.0f; s.spectralDb = 1.0f; });
+        
+        return scenarios;
+    }
+    
+    // lowbias32 by Chris Wellons, as NoiseGenerator uses
+    uint32 hash(uint32 x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+    
+    // clicks of seeded heights, a chirp from 80 Hz to 5 kHz and a little
+    // hash noise, different on each channel
+    void fillExt(AudioBuffer<float>& buffer, double sampleRate, uint32 seed)
+    {
+        constexpr int clickSpacing = 1500;
+        auto seconds = renderLength / sampleRate;
+        auto rate = std::log(5000.0 / 80.0) / seconds;
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto key = hash(seed * 2u + uint32(ch));
+            
+            for (int s = 0; s < renderLength; ++s)
+            {
+                auto t = s / sampleRate;
+                auto phase = MathConstants<double>::twoPi * 80.0 * (std::exp(rate * t) - 1.0) / rate;
+                auto noise = float(int32(hash(uint32(s) ^ key))) / 2147483648.0f;
+                auto sample = 0.15f * float(std::sin(phase)) + 0.05f * noise;
+                
+                if ((s + ch * 250) % clickSpacing == 0)
+                    sample += 0.25f + 0.5f * float(hash(uint32(s) + key) >> 8) / 16777216.0f;
+                
+                buffer.setSample(ch, s, sample);
+            }
+        }
+    }
+    
+    AudioBuffer<float> render(const Scenario& scenario)
+    {
+        AudioBuffer<float> input(numChannels, renderLength), output(numChannels, renderLength);
+        output.clear();
+        
+        if (scenario.input == Input::Ext)
+        {
+            fillExt(input, scenario.sampleRate, scenario.seed);
+        }
+        else
+        {
+            NoiseGenerator noise;
+            noise.prepare(scenario.sampleRate);
+            noise.setStream(scenario.seed);
+            noise.setColour(scenario.input == Input::Pink ? NoiseGenerator::Colour::Pink
+                            : scenario.input == Input::Brown ? NoiseGenerator::Colour::Brown : NoiseGenerator::Colour::White);
+            noise.process(input.getArrayOfWritePointers(), numChannels, renderLength);
+        }
+        
+        CombProcessor comb(MAX_NUM_FILTERS);
+        comb.setMultirate(false);
+        comb.prepare({ scenario.sampleRate, uint32(blockSize), uint32(numChannels) });
+        
+        auto params = [&] (int note)
+        {
+            return CombProcessor::Parameters(midiToFreq(note), scenario.resonance, scenario.timbre, scenario.curve,
+                                             scenario.spread, scenario.glide, scenario.mode, scenario.harmonics, scenario.engine);
+        };
+        
+        comb.updateParams(params(scenario.note));
+        comb.restart();
+        
+        for (int start = 0; start < renderLength; start += blockSize)
+        {
+            if (start == renderLength / 4 && scenario.glideNote >= 0)
+                comb.updateParams(params(scenario.glideNote));
+            
+            comb.process(input, output, jmin(blockSize, renderLength - start), start);
+        }
+        
+        return output;
+    }
+    
+    //==============================================================================
+    // 32-bit float WAVs, little-endian like every platform the plugin builds for
+    
+    template <typename Value>
+    void put(std::ofstream& stream, Value value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    
+    bool writeWav(const std::filesystem::path& path, const AudioBuffer<float>& buffer, double sampleRate)
+    {
+        std::ofstream stream(path, std::ios::binary);
+        auto dataSize = uint32(buffer.getNumChannels() * buffer.getNumSamples() * 4);
+        
+        stream.write("RIFF", 4);
+        put(stream, uint32(36 + dataSize));
+        stream.write("WAVEfmt ", 8);
+        put(stream, uint32(16));
+        put(stream, uint16(3));
+        put(stream, uint16(buffer.getNumChannels()));
+        put(stream, uint32(sampleRate));
+        put(stream, uint32(sampleRate) * uint32(buffer.getNumChannels()) * 4u);
+        put(stream, uint16(buffer.getNumChannels() * 4));
+        put(stream, uint16(32));
+        stream.write("data", 4);
+        put(stream, dataSize);
+        
+        for (int s = 0; s < buffer.getNumSamples(); ++s)
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                put(stream, buffer.getSample(ch, s));
+        
+        return stream.good();
+    }
+    
+    bool readWav(const std::filesystem::path& path, AudioBuffer<float>& buffer)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        std::vector<char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        
+        if (file.size() < 12 || std::memcmp(file.data(), "RIFF", 4) != 0 || std::memcmp(file.data() + 8, "WAVE", 4) != 0)
+            return false;
+        
+        auto get = [&] (size_t offset, auto value)
+        {
+            std::memcpy(&value, file.data() + offset, sizeof(value));
+            return value;
+        };
+        
+        int channels = 0, bits = 0, format = 0;
+        
+        for (size_t offset = 12; offset + 8 <= file.size();)
+        {
+            auto size = size_t(get(offset + 4, uint32()));
+            auto body = offset + 8;
+            
+            if (body + size > file.size())
+                return false;
+            
+            if (std::memcmp(file.data() + offset, "fmt ", 4) == 0 && size >= 16)
+            {
+                format = get(body, uint16());
+                channels = get(body + 2, uint16());
+                bits = get(body + 14, uint16());
+            }
+            else if (std::memcmp(file.data() + offset, "data", 4) == 0)
+            {
+                if (format != 3 || bits != 32 || channels < 1)
+                    return false;
+                
+                auto numSamples = int(size / size_t(channels * 4));
+                buffer.setSize(channels, numSamples);
+                
+                for (int s = 0; s < numSamples; ++s)
+                    for (int ch = 0; ch < channels; ++ch)
+                        buffer.setSample(ch, s, get(body + size_t((s * channels + ch) * 4), 0.0f));
+                
+                return true;
+            }
+            
+            offset = body + size + (size & 1);
+        }
+        
+        return false;
+    }
+    
+    //==============================================================================
+    void fft(std::vector<std::complex<double>>& data)
+    {
+        auto n = data.size();
+        
+        for (size_t i = 1, j = 0; i < n; ++i)
+        {
+            auto bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            
+            if (i < j)
+                std::swap(data[i], data[j]);
+        }
+        
+        for (size_t length = 2; length <= n; length <<= 1)
+        {
+            auto step = std::polar(1.0, -MathConstants<double>::twoPi / double(length));
+            
+            for (size_t i = 0; i < n; i += length)
+            {
+                std::complex<double> w(1.0);
+                
+                for (size_t k = 0; k < length / 2; ++k)
+                {
+                    auto even = data[i + k];
+                    auto odd = data[i + k + length / 2] * w;
+                    data[i + k] = even + odd;
+                    data[i + k + length / 2] = even - odd;
+                    w *= step;
+                }
+            }
+        }
+    }
+    
+    // power in each sixth of an octave from 20 Hz up, averaged over Hann
+    // windowed frames overlapping by half, and over the channels
+    std::vector<double> bandPowers(const AudioBuffer<float>& buffer, double sampleRate)
+    {
+        std::vector<double> spectrum(fftSize / 2 + 1, 0.0);
+        std::vector<std::complex<double>> frame(fftSize);
+        
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            for (int start = 0; start + fftSize <= buffer.getNumSamples(); start += fftSize / 2)
+            {
+                for (int i = 0; i < fftSize; ++i)
+                {
+                    auto window = 0.5 - 0.5 * std::cos(MathConstants<double>::twoPi * i / fftSize);
+                    frame[size_t(i)] = window * buffer.getSample(ch, start + i);
+                }
+                
+                fft(frame);
+                
+                for (size_t bin = 0; bin < spectrum.size(); ++bin)
+                    spectrum[bin] += std::norm(frame[bin]);
+            }
+        }
+        
+        std::vector<double> bands;
+        auto binWidth = sampleRate / fftSize;
+        
+        for (double low = 20.0; low < sampleRate / 2.0; low *= std::pow(2.0, 1.0 / 6.0))
+        {
+            auto high = low * std::pow(2.0, 1.0 / 6.0);
+            double power = 0.0;
+            
+            for (size_t bin = 0; bin < spectrum.size(); ++bin)
+                if (bin * binWidth >= low && bin * binWidth < high)
+                    power += spectrum[bin];
+            
+            // the lowest bands are narrower than a bin and stay empty
+            if (high > binWidth)
+                bands.push_back(power);
+        }
+        
+        return bands;
+    }
+    
+    double toDb(double power)
+    {
+        return 10.0 * std::log10(jmax(power, 1.0e-30));
+    }
+    
+    struct Comparison
+    {
+        double sampleDb = 0.0, spectralDb = 0.0;
+        bool ok = false;
+    };
+    
+    Comparison compare(const Scenario& scenario, const AudioBuffer<float>& rendered, const AudioBuffer<float>& reference)
+    {
+        Comparison result;
+        
+        if (rendered.getNumChannels() != reference.getNumChannels() || rendered.getNumSamples() != reference.getNumSamples())
+        {
+            result.sampleDb = result.spectralDb = 1.0e9;
+            return result;
+        }
+        
+        double errorPower = 0.0, referencePower = 0.0;
+        
+        for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+        {
+            for (int s = 0; s < reference.getNumSamples(); ++s)
+            {
+                auto difference = double(rendered.getSample(ch, s)) - double(reference.getSample(ch, s));
+                errorPower += difference * difference;
+                referencePower += square(double(reference.getSample(ch, s)));
+            }
+        }
+        
+        // NaNs compare false, so they fail below
+        result.sampleDb = std::isfinite(errorPower) ? toDb(errorPower) - toDb(referencePower) : 1.0e9;
+        
+        auto renderedBands = bandPowers(rendered, scenario.sampleRate);
+        auto referenceBands = bandPowers(reference, scenario.sampleRate);
+        double loudest = 0.0;
+        
+        for (auto power : referenceBands)
+            loudest = jmax(loudest, power);
+        
+        // a band that appears out of nowhere counts as much as one that changes
+        for (size_t band = 0; band < referenceBands.size(); ++band)
+        {
+            auto floor = toDb(loudest) + scenario.spectralFloorDb;
+            auto renderedDb = jmax(toDb(renderedBands[band]), floor);
+            auto referenceDb = jmax(toDb(referenceBands[band]), floor);
+            
+            result.spectralDb = jmax(result.spectralDb, std::abs(renderedDb - referenceDb));
+        }
+        
+        result.ok = result.sampleDb <= scenario.sampleDb && result.spectralDb <= scenario.spectralDb;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    auto directory = std::filesystem::path(__FILE__).parent_path() / "golden";
+    bool update = false;
+    std::string only;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--update") == 0)
+            update = true;
+        else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            directory = argv[++i];
+        else if (std::strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: GoldenRenderTest [--golden dir] [--update] [--only name]\n");
+            return 2;
+        }
+    }
+    
+    if (update)
+        std::filesystem::create_directories(directory);
+    
+    int numFailures = 0;
+    
+    std::printf("%-18s %12s %12s\n", "", "sample dB", "spectral dB");
+    
+    for (auto& scenario : makeScenarios())
+    {
+        if (! only.empty() && only != scenario.name)
+            continue;
+        
+        auto rendered = render(scenario);
+        auto path = directory / (std::string(scenario.name) + ".wav");
+        
+        if (update)
+        {
+            auto ok = writeWav(path, rendered, scenario.sampleRate);
+            std::printf("%-18s %s\n", scenario.name, ok ? "written" : "FAILED to write");
+            numFailures += ok ? 0 : 1;
+            continue;
+        }
+        
+        AudioBuffer<float> reference;
+        
+        if (! readWav(path, reference))
+        {
+            std::printf("%-18s no reference at %s, run with --update\n", scenario.name, path.string().c_str());
+            ++numFailures;
+            continue;
+        }
+        
+        auto result = compare(scenario, rendered, reference);
+        std::printf("%-18s %6.1f/%5.1f %6.2f/%5.2f %s\n", scenario.name, result.sampleDb, scenario.sampleDb,
+                    result.spectralDb, scenario.spectralDb, result.ok ? "ok" : "FAILED");
+        
+        numFailures += result.ok ? 0 : 1;
+    }
+    
+    return numFailures == 0 ? 0 : 1;
+}
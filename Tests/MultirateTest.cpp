@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    MultirateTest.cpp
+    Created: 17 Oct 2026 1:49:48pm
+    Author:  Kevin Kopczynski
+
+    Checks CombProcessor's default multirate path against the full-rate
+    one, for every engine, at a host rate that splits it into subbands and
+    at one that doesn't. A burst of noise is played through each, and the
+    multirate output moved back by getLatency() has to line up with the
+    full-rate output: the waveguide's sample for sample, and the banks'
+    within the half-band filters' error, with nothing of note before the
+    reported latency. The banks' output is matched by its correlation with
+    the full-rate output, which has to peak at the reported latency, as the
+    subbands' filters move the partials' phase a little too. So the latency
+    the plugin reports is the one every engine has.
+
+    CMake target MultirateTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/audio/CombProcessor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace audio;
+
+namespace
+{
+    using Engine = CombProcessor::Engine;
+    
+    constexpr int blockSize = 256;
+    constexpr int numChannels = 2;
+    constexpr int burstLength = 4096;
+    constexpr int totalLength = 65536;
+    // the banks' multirate output against their full-rate output lined up
+    // by the latency, as a normalised correlation
+    constexpr double minBankCorrelation = 0.98;
+    // lags either side of the latency the correlation has to be lower at,
+    // past the couple of samples the modal resonators' phase moves by at a
+    // quarter or an eighth of the rate
+    constexpr int lagSearch = 32;
+    constexpr int maxLagError = 2;
+    // output before the latency under the whole render's peak, which is
+    // the half-band filters' pre-ringing
+    constexpr double maxEarlyDb = -20.0;
+    
+    // the left channel of a burst of noise through a comb from cleared
+    std::vector<float> render(double sampleRate, Engine engine, bool multirate, int& latency)
+    {
+        CombProcessor comb(MAX_NUM_FILTERS);
+        comb.setMultirate(multirate);
+        comb.prepare({ sampleRate, uint32(blockSize), uint32(numChannels) });
+        comb.updateParams(CombProcessor::Parameters(110.0f, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, GLIDE_MIN,
+                                                    CombProcessor::FreqOutOfBoundsMode::Ignore, HARMONICS_DEFAULT, engine));
+        comb.restart();
+        latency = comb.getLatency();
+        
+        AudioBuffer<float> buffer(numChannels, blockSize);
+        Random random(1);
+        std::vector<float> output;
+        
+        for (int pos = 0; pos < totalLength; pos += blockSize)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    buffer.setSample(ch, s, pos + s < burstLength ? random.nextFloat() * 0.5f - 0.25f : 0.0f);
+            
+            comb.process(buffer, blockSize);
+            
+            for (int s = 0; s < blockSize; ++s)
+                output.push_back(buffer.getSample(0, s));
+        }
+        
+        return output;
+    }
+    
+    // of a moved back by lag against b
+    double correlation(const std::vector<float>& a, const std::vector<float>& b, int lag)
+    {
+        double ab = 0.0, aa = 0.0, bb = 0.0;
+        
+        for (int s = 0; s + lag < totalLength; ++s)
+        {
+            auto x = double(a[size_t(s + lag)]), y = double(b[size_t(s)]);
+            ab += x * y;
+            aa += x * x;
+            bb += y * y;
+        }
+        
+        return ab / std::sqrt(jmax(aa * bb, 1.0e-30));
+    }
+    
+    int check(double sampleRate, Engine engine, const char* engineName)
+    {
+        int multirateLatency = 0, fullRateLatency = 0;
+        auto multirate = render(sampleRate, engine, true, multirateLatency);
+        auto fullRate = render(sampleRate, engine, false, fullRateLatency);
+        
+        // subbands only from MULTIRATE_MIN_HOST_RATE up, and never with full rate
+        auto latencyOk = fullRateLatency == 0 && (multirateLatency > 0) == (sampleRate >= MULTIRATE_MIN_HOST_RATE);
+        
+        double peak = 0.0, early = 0.0;
+        auto exact = true;
+        
+        for (int s = 0; s + multirateLatency < totalLength; ++s)
+        {
+            exact = exact && multirate[size_t(s + multirateLatency)] == fullRate[size_t(s)];
+            peak = jmax(peak, std::abs(double(fullRate[size_t(s)])));
+        }
+        
+        for (int s = 0; s < multirateLatency; ++s)
+            early = jmax(early, std::abs(double(multirate[size_t(s)])));
+        
+        auto atLatency = correlation(multirate, fullRate, multirateLatency);
+        auto bestLag = multirateLatency;
+        
+        for (int lag = jmax(0, multirateLatency - lagSearch); lag <= multirateLatency + lagSearch; ++lag)
+            if (correlation(multirate, fullRate, lag) > correlation(multirate, fullRate, bestLag))
+                bestLag = lag;
+        
+        auto earlyDb = 20.0 * std::log10(jmax(early, 1.0e-15) / peak);
+        // the waveguide doesn't go through the subbands, it's only delayed,
+        // and without subbands the banks run exactly as at full rate
+        auto alignedOk = engine == Engine::Waveguide || multirateLatency == 0
+                       ? exact
+                       : atLatency >= minBankCorrelation && std::abs(bestLag - multirateLatency) <= maxLagError;
+        auto earlyOk = multirateLatency == 0 || earlyDb < maxEarlyDb;
+        auto ok = latencyOk && alignedOk && earlyOk && peak > 0.0;
+        
+        std::printf("%6.0f Hz %-10s %s, latency %d, best lag %d, correlation %.4f, before latency %.1f dB\n", sampleRate, engineName,
+                    ok ? "ok" : "FAILED", multirateLatency, bestLag, atLatency, multirateLatency > 0 ? earlyDb : -INFINITY);
+        
+        return ok ? 0 : 1;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    for (auto sampleRate : { 48000.0, 96000.0, 192000.0 })
+    {
+        numFailures += check(sampleRate, Engine::SVF, "svf");
+        numFailures += check(sampleRate, Engine::Modal, "modal");
+        numFailures += check(sampleRate, Engine::Waveguide, "waveguide");
+    }
+    
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    OnsetTimingTest.cpp
+    Created: 17 Oct 2026 12:16:57pm
+    Author:  Kevin Kopczynski
+
+    Checks that notes start and stop on the sample their MIDI events fall
+    on, for a 1/64 note arpeggio at 240 bpm whose events land anywhere in
+    the block. Each note is short with a short release, so the output is
+    exactly silent from a while after one note's release until the next
+    note's first sample. Runs the plain, threaded and batched render paths.
+
+    CMake target OnsetTimingTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSynth.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numChannels = 2;
+    constexpr int numVoices = 8;
+    // a 1/64 note at 240 bpm, not a divisor of the block size
+    constexpr int noteSpacing = 750;
+    constexpr int noteLength = 300;
+    constexpr float releaseSeconds = 0.002f;
+    constexpr int numNotes = 64;
+    constexpr int arpeggio[] = { 48, 55, 60, 64, 67, 72, 76, 79 };
+    
+    struct Note
+    {
+        int onset, offset;
+    };
+    
+    // every note's on and off events, each one a few samples later than the
+    // last so they drift through every offset within the block
+    std::vector<Note> makeNotes()
+    {
+        std::vector<Note> notes;
+        
+        for (int i = 0; i < numNotes; ++i)
+        {
+            auto onset = blockSize + i * noteSpacing + (i * 7) % 13;
+            notes.push_back({ onset, onset + noteLength });
+        }
+        
+        return notes;
+    }
+    
+    std::vector<float> render(const std::vector<Note>& notes, int numRenderThreads, bool voiceBatching)
+    {
+        test::SynthSetup setup;
+        setup.sampleRate = sampleRate;
+        setup.blockSize = blockSize;
+        setup.numChannels = numChannels;
+        setup.numVoices = numVoices;
+        setup.numRenderThreads = numRenderThreads;
+        setup.voiceBatching = voiceBatching;
+        setup.glide = GLIDE_MIN;
+        setup.envelope = audio::Envelope::Parameters(0.001f, 0.01f, 0.8f, releaseSeconds);
+        
+        Synth synth;
+        test::prepareSynth(synth, setup);
+        
+        auto totalLength = notes.back().offset + noteSpacing;
+        std::vector<float> output;
+        AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        
+        for (int start = 0; start < totalLength; start += blockSize)
+        {
+            MidiBuffer midi;
+            
+            for (size_t i = 0; i < notes.size(); ++i)
+            {
+                auto note = arpeggio[i % std::size(arpeggio)];
+                
+                if (notes[i].onset >= start && notes[i].onset < start + blockSize)
+                    midi.addEvent(MidiMessage::noteOn(1, note, 1.0f), notes[i].onset - start);
+                if (notes[i].offset >= start && notes[i].offset < start + blockSize)
+                    midi.addEvent(MidiMessage::noteOff(1, note), notes[i].offset - start);
+            }
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    excitation.setSample(ch, s, random.nextFloat() * 0.5f);
+            
+            buffer.clear();
+            synth.setExcitation(excitation);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            
+            for (int s = 0; s < blockSize; ++s)
+                output.push_back(buffer.getSample(0, s));
+        }
+        
+        return output;
+    }
+    
+    // the first sample at or after from that isn't silent, or to
+    int firstSound(const std::vector<float>& output, int from, int to)
+    {
+        for (int s = from; s < to; ++s)
+            if (output[size_t(s)] != 0.0f)
+                return s;
+        
+        return to;
+    }
+    
+    // the sample after the last one before to that isn't silent, or from
+    int lastSound(const std::vector<float>& output, int from, int to)
+    {
+        for (int s = to; s > from; --s)
+            if (output[size_t(s - 1)] != 0.0f)
+                return s;
+        
+        return from;
+    }
+    
+    int check(const char* name, int numRenderThreads, bool voiceBatching)
+    {
+        auto notes = makeNotes();
+        auto output = render(notes, numRenderThreads, voiceBatching);
+        auto releaseSamples = int(std::ceil(releaseSeconds * sampleRate));
+        int numFailures = 0;
+        
+        for (size_t i = 0; i < notes.size(); ++i)
+        {
+            auto silenceFrom = i == 0 ? 0 : notes[i - 1].offset + releaseSamples + 1;
+            auto onset = firstSound(output, silenceFrom, notes[i].offset);
+            // the release may end a sample or two early as the envelope rounds down
+            auto end = lastSound(output, notes[i].onset, notes[i].offset + releaseSamples + 1);
+            
+            if (onset != notes[i].onset || end < notes[i].offset + releaseSamples - 2)
+            {
+                std::printf("%s: note %d expected %d - %d, heard %d - %d\n", name, int(i), notes[i].onset, notes[i].offset + releaseSamples, onset, end);
+                ++numFailures;
+            }
+        }
+        
+        std::printf("%-10s %s\n", name, numFailures == 0 ? "ok" : "FAILED");
+        return numFailures;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += check("plain", 0, false);
+    numFailures += check("threaded", 2, false);
+    numFailures += check("batched", 0, true);
+    
+    return numFailures == 0 ? 0 : 1;
+}
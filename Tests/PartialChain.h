@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    PartialChain.h
+    Created: 17 Oct 2026 2:17:13pm
+    Author:  Kevin Kopczynski
+
+    The filter, gain and accumulate chain CombProcessor ran before
+    FilterBank fused it: per partial, a copy of the block through a
+    dsp::StateVariableTPTFilter, the timbre gain, the curve gain, then
+    added to the output. Kept as the reference FusedFilterTest checks the
+    bank against and FusedBench times it against. Header only, so the
+    CMake build doesn't make a target of it.
+
+  ==============================================================================
+*/
+
+#ifndef PARTIALCHAIN_H
+#define PARTIALCHAIN_H
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+namespace test
+{
+    // what each partial is filtered at and scaled by
+    struct Partials
+    {
+        std::vector<float> cutoffs, resonances, timbreGains, curveGains;
+        
+        int size() const { return int(cutoffs.size()); }
+        
+        // the two gains as one, as FilterBank takes them
+        std::vector<float> getGains() const
+        {
+            std::vector<float> gains(cutoffs.size());
+            for (size_t i = 0; i < gains.size(); ++i)
+                gains[i] = timbreGains[i] * curveGains[i];
+            
+            return gains;
+        }
+    };
+    
+    class PartialChain
+    {
+    public:
+        PartialChain(const Partials& partialsToUse, double sampleRate, int numChannels, int maxBlockSize)
+            : partials(partialsToUse), filters(partialsToUse.cutoffs.size())
+        {
+            for (size_t i = 0; i < filters.size(); ++i)
+            {
+                filters[i].setType(dsp::StateVariableTPTFilterType::bandpass);
+                filters[i].prepare({ sampleRate, uint32(maxBlockSize), uint32(numChannels) });
+                filters[i].setCutoffFrequency(jmin(partials.cutoffs[i], float(sampleRate) * 0.499f));
+                filters[i].setResonance(partials.resonances[i]);
+            }
+            
+            temp.setSize(numChannels, maxBlockSize);
+            out.setSize(numChannels, maxBlockSize);
+        }
+        
+        void process(const AudioBuffer<float>& input, AudioBuffer<float>& output, int numSamples)
+        {
+            out.clear();
+            
+            for (size_t i = 0; i < filters.size(); ++i)
+            {
+                for (int ch = 0; ch < out.getNumChannels(); ++ch)
+                {
+                    auto* samples = temp.getWritePointer(ch);
+                    FloatVectorOperations::copy(samples, input.getReadPointer(ch), numSamples);
+                    
+                    for (int s = 0; s < numSamples; ++s)
+                        samples[s] = filters[i].processSample(ch, samples[s]);
+                    
+                    FloatVectorOperations::multiply(samples, partials.timbreGains[i], numSamples);
+                    FloatVectorOperations::multiply(samples, partials.curveGains[i], numSamples);
+                    FloatVectorOperations::add(out.getWritePointer(ch), samples, numSamples);
+                }
+            }
+            
+            for (int ch = 0; ch < out.getNumChannels(); ++ch)
+                FloatVectorOperations::copy(output.getWritePointer(ch), out.getReadPointer(ch), numSamples);
+        }
+    
+    private:
+        const Partials& partials;
+        std::vector<dsp::StateVariableTPTFilter<float>> filters;
+        AudioBuffer<float> temp, out;
+    };
+}
+
+#endif // PARTIALCHAIN_H
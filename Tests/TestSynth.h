@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    TestSynth.h
+    Created: 17 Oct 2026 1:36:15pm
+    Author:  Kevin Kopczynski
+
+    The synth the tests render, built the way PluginProcessor builds its
+    own. Header only, so the CMake build doesn't make a target of it.
+
+  ==============================================================================
+*/
+
+#ifndef TESTSYNTH_H
+#define TESTSYNTH_H
+
+#include <JuceHeader.h>
+#include "../Source/synth/Synth.h"
+
+namespace test
+{
+    struct SynthSetup
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int numChannels = 2;
+        int numVoices = 8;
+        // notes that play at once, every voice if 0
+        int polyphony = 0;
+        int numRenderThreads = 0;
+        bool voiceBatching = false;
+        bool multirate = false;
+        bool deterministic = false;
+        float glide = GLIDE_DEFAULT;
+        audio::Envelope::Parameters envelope { 0.001f, 0.01f, 0.8f, 0.05f };
+    };
+    
+    // adds numVoices voices to an empty synth, every one on the SVF engine
+    // with the default comb settings, and prepares it. A test can pass its
+    // own SynthVoice subclass to look inside the render
+    template <typename Voice = SynthVoice>
+    void prepareSynth(Synth& synth, const SynthSetup& setup)
+    {
+        synth.addSound(new SynthSound());
+        synth.setCurrentPlaybackSampleRate(setup.sampleRate);
+        
+        for (int v = 0; v < setup.numVoices; ++v)
+        {
+            auto voice = new Voice();
+            voice->getCombProcessor().setMultirate(setup.multirate);
+            voice->prepareToPlay(setup.sampleRate, setup.blockSize, setup.numChannels);
+            voice->getCombProcessor().updateParams(audio::CombProcessor::Parameters(-1.0f, RESONANCE_DEFAULT, TIMBRE_DEFAULT, CURVE_DEFAULT, SPREAD_DEFAULT, setup.glide,
+                                                                                    audio::CombProcessor::FreqOutOfBoundsMode::Ignore, HARMONICS_DEFAULT, audio::CombProcessor::Engine::SVF));
+            voice->getEnvelope().setParameters(setup.envelope);
+            synth.addVoice(voice);
+        }
+        
+        synth.setDeterministic(setup.deterministic);
+        synth.prepare(setup.numRenderThreads, setup.voiceBatching, setup.blockSize);
+        synth.setPolyphony(setup.polyphony > 0 ? setup.polyphony : setup.numVoices);
+    }
+}
+
+#endif // TESTSYNTH_H
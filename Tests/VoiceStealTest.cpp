@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+    VoiceStealTest.cpp
+    Created: 17 Oct 2026 1:56:03pm
+    Author:  Kevin Kopczynski
+
+    Checks that a voice leaves without a click, both when a note over the
+    polyphony steals it and when Synth::setNumVoicesInUse() takes it out
+    of a shrinking pool. Two notes play at a polyphony of two, the first
+    released so it is the quieter, and then a third note comes in. The
+    quietest voice by getLoudness() has to be the one stolen, and the same
+    render without the third note is the reference: the stolen voice's
+    output is the reference's under a gain that only falls, by no more
+    than a STEAL_FADE_MS fade's step per sample, and is silent after it.
+
+    A chord change at a polyphony of three then steals three voices in one
+    block, one more than NUM_STEAL_VOICES. Every old voice fades the same
+    way, and the note that found no spare free waits on one of them and
+    starts from silence as that fade ends, rather than snapping its gain
+    back up on a ringing comb.
+
+    CMake target VoiceStealTest, run by ctest. Returns non-zero on failure.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TestSynth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numChannels = 2;
+    constexpr int numVoices = 4;
+    constexpr int polyphony = 2;
+    // the first note's release, and how far into it the third note comes
+    constexpr float releaseSeconds = 0.5f;
+    constexpr int firstNoteOff = 4 * blockSize;
+    constexpr int thirdNoteOn = 12 * blockSize + 77;
+    constexpr int totalLength = 24 * blockSize;
+    // the chords, a note more than the spares apart
+    constexpr int chordPolyphony = 3;
+    constexpr int firstChord[] = { 60, 64, 67 };
+    constexpr int secondChord[] = { 62, 65, 69 };
+    constexpr int chordChange = thirdNoteOn;
+    constexpr float chordAttackSeconds = 0.001f;
+    
+    int getFadeLength() { return roundToInt(STEAL_FADE_MS / 1000.0 * sampleRate); }
+    
+    // keeps what it adds to the output, sample for sample, on its own
+    class RecordingVoice : public SynthVoice
+    {
+    public:
+        void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
+        {
+            own.setSize(outputBuffer.getNumChannels(), outputBuffer.getNumSamples(), false, false, true);
+            own.clear(startSample, numSamples);
+            SynthVoice::renderNextBlock(own, startSample, numSamples);
+            
+            for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
+                outputBuffer.addFrom(ch, startSample, own, ch, startSample, numSamples);
+            
+            for (int s = 0; s < numSamples; ++s)
+                output[size_t(blockStart + startSample + s)] = own.getSample(0, startSample + s);
+        }
+        
+        AudioBuffer<float> own;
+        std::vector<float> output = std::vector<float>(size_t(totalLength), 0.0f);
+        int blockStart = 0;
+    };
+    
+    struct Render
+    {
+        std::vector<float> stolen, playing;
+        // the voices the first two notes played on, and which one was the quietest before the third
+        int firstVoice = -1, secondVoice = -1, quietestVoice = -1;
+        bool thirdStole = false;
+    };
+    
+    // the first two notes, and the third if withThirdNote. With shrinkPool
+    // the pool is cut to the first voice at the third note's block instead
+    Render render(bool withThirdNote, bool shrinkPool)
+    {
+        test::SynthSetup setup;
+        setup.sampleRate = sampleRate;
+        setup.blockSize = blockSize;
+        setup.numChannels = numChannels;
+        setup.numVoices = numVoices;
+        setup.polyphony = polyphony;
+        setup.envelope = audio::Envelope::Parameters(0.001f, 0.01f, 0.8f, releaseSeconds);
+        
+        Synth synth;
+        test::prepareSynth<RecordingVoice>(synth, setup);
+        
+        AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        Render result;
+        
+        auto voiceOf = [&synth] (int note)
+        {
+            for (int v = 0; v < synth.getNumVoices(); ++v)
+                if (synth.getVoice(v)->getCurrentlyPlayingNote() == note)
+                    return v;
+            
+            return -1;
+        };
+        
+        for (int start = 0; start < totalLength; start += blockSize)
+        {
+            MidiBuffer midi;
+            
+            if (start == 0)
+            {
+                midi.addEvent(MidiMessage::noteOn(1, 60, 1.0f), 0);
+                midi.addEvent(MidiMessage::noteOn(1, 64, 1.0f), 0);
+            }
+            
+            if (firstNoteOff >= start && firstNoteOff < start + blockSize)
+                midi.addEvent(MidiMessage::noteOff(1, 60), firstNoteOff - start);
+            
+            if (thirdNoteOn >= start && thirdNoteOn < start + blockSize)
+            {
+                float quietestLevel = 0.0f;
+                
+                for (int v = 0; v < synth.getNumVoices(); ++v)
+                {
+                    auto* voice = synth.getSynthVoices()[size_t(v)];
+                    
+                    if (voice->isVoiceActive() && (result.quietestVoice < 0 || voice->getLoudness() < quietestLevel))
+                    {
+                        result.quietestVoice = v;
+                        quietestLevel = voice->getLoudness();
+                    }
+                }
+                
+                if (withThirdNote)
+                    midi.addEvent(MidiMessage::noteOn(1, 67, 1.0f), thirdNoteOn - start);
+                
+                // the pool shrinks at the start of the block, so the fade does too
+                if (shrinkPool)
+                    synth.setNumVoicesInUse(result.firstVoice);
+            }
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    excitation.setSample(ch, s, random.nextFloat() * 0.5f);
+            
+            for (auto* voice : synth.getSynthVoices())
+                static_cast<RecordingVoice*>(voice)->blockStart = start;
+            
+            buffer.clear();
+            synth.setExcitation(excitation);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            
+            if (start == 0)
+            {
+                result.firstVoice = voiceOf(60);
+                result.secondVoice = voiceOf(64);
+            }
+            
+            if (withThirdNote && thirdNoteOn >= start && thirdNoteOn < start + blockSize)
+                result.thirdStole = synth.getSynthVoices()[size_t(result.quietestVoice)]->isStealFading();
+        }
+        
+        if (result.firstVoice >= 0 && result.secondVoice >= 0)
+        {
+            result.stolen = static_cast<RecordingVoice*>(synth.getSynthVoices()[size_t(result.firstVoice)])->output;
+            result.playing = static_cast<RecordingVoice*>(synth.getSynthVoices()[size_t(result.secondVoice)])->output;
+        }
+        
+        return result;
+    }
+    
+    struct ChordRender
+    {
+        // every voice's output, and the voices each note ended up on
+        std::vector<std::vector<float>> voices;
+        std::vector<int> firstVoices, secondVoices;
+    };
+    
+    // the first chord, held, and the second over it if withChange
+    ChordRender renderChords(bool withChange)
+    {
+        test::SynthSetup setup;
+        setup.sampleRate = sampleRate;
+        setup.blockSize = blockSize;
+        setup.numChannels = numChannels;
+        setup.numVoices = chordPolyphony + NUM_STEAL_VOICES;
+        setup.polyphony = chordPolyphony;
+        setup.envelope = audio::Envelope::Parameters(chordAttackSeconds, 0.01f, 0.8f, releaseSeconds);
+        
+        Synth synth;
+        test::prepareSynth<RecordingVoice>(synth, setup);
+        
+        AudioBuffer<float> excitation(numChannels, blockSize), buffer(numChannels, blockSize);
+        Random random(1);
+        ChordRender result;
+        
+        auto voiceOf = [&synth] (int note)
+        {
+            for (int v = 0; v < synth.getNumVoices(); ++v)
+                if (synth.getVoice(v)->getCurrentlyPlayingNote() == note)
+                    return v;
+            
+            return -1;
+        };
+        
+        for (int start = 0; start < totalLength; start += blockSize)
+        {
+            MidiBuffer midi;
+            
+            if (start == 0)
+                for (auto note : firstChord)
+                    midi.addEvent(MidiMessage::noteOn(1, note, 1.0f), 0);
+            
+            if (withChange && chordChange >= start && chordChange < start + blockSize)
+                for (auto note : secondChord)
+                    midi.addEvent(MidiMessage::noteOn(1, note, 1.0f), chordChange - start);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int s = 0; s < blockSize; ++s)
+                    excitation.setSample(ch, s, random.nextFloat() * 0.5f);
+            
+            for (auto* voice : synth.getSynthVoices())
+                static_cast<RecordingVoice*>(voice)->blockStart = start;
+            
+            buffer.clear();
+            synth.setExcitation(excitation);
+            synth.renderNextBlock(buffer, midi, 0, blockSize);
+            
+            if (start == 0)
+                for (auto note : firstChord)
+                    result.firstVoices.push_back(voiceOf(note));
+        }
+        
+        for (auto note : secondChord)
+            result.secondVoices.push_back(voiceOf(note));
+        
+        for (auto* voice : synth.getSynthVoices())
+            result.voices.push_back(static_cast<RecordingVoice*>(voice)->output);
+        
+        return result;
+    }
+    
+    int fail(const char* test, const char* what)
+    {
+        std::printf("%-12s FAILED, %s\n", test, what);
+        return 1;
+    }
+    
+    // the voice's output against the reference's from fadeStart on: a gain
+    // that starts at 1, falls by at most a fade's step a sample and never
+    // rises, then silence until silentUntil
+    int checkFade(const char* test, const std::vector<float>& faded, const std::vector<float>& reference, int fadeStart, int silentUntil = totalLength)
+    {
+        auto fadeLength = getFadeLength();
+        auto maxStep = 1.0f / float(fadeLength);
+        auto peak = 0.0f;
+        
+        for (auto sample : reference)
+            peak = jmax(peak, std::abs(sample));
+        
+        for (int s = 0; s < fadeStart; ++s)
+            if (faded[size_t(s)] != reference[size_t(s)])
+                return fail(test, "the voice changes before it's taken");
+        
+        // the gain is only read where the reference is well clear of zero,
+        // and then only to within gainTolerance
+        constexpr float gainTolerance = 0.01f;
+        auto lastGain = 1.0f;
+        auto lastSample = fadeStart - 1;
+        
+        for (int s = fadeStart; s < fadeStart + fadeLength; ++s)
+        {
+            if (std::abs(faded[size_t(s)]) > std::abs(reference[size_t(s)]) + 1.0e-6f)
+                return fail(test, "the voice gets louder");
+            
+            if (std::abs(reference[size_t(s)]) < 0.05f * peak)
+                continue;
+            
+            auto gain = faded[size_t(s)] / reference[size_t(s)];
+            
+            if (gain > lastGain + gainTolerance || lastGain - gain > maxStep * float(s - lastSample) + gainTolerance)
+            {
+                std::printf("at sample %d the gain goes from %g to %g\n", s - fadeStart, double(lastGain), double(gain));
+                return fail(test, "the voice is cut rather than faded");
+            }
+            
+            lastGain = gain;
+            lastSample = s;
+        }
+        
+        for (int s = fadeStart + fadeLength; s < silentUntil; ++s)
+            if (faded[size_t(s)] != 0.0f)
+                return fail(test, "the voice plays on after its fade");
+        
+        std::printf("%-12s ok, faded over %d samples\n", test, fadeLength);
+        return 0;
+    }
+    
+    int checkSteal()
+    {
+        auto reference = render(false, false);
+        auto stealing = render(true, false);
+        
+        if (stealing.firstVoice < 0 || stealing.secondVoice < 0 || stealing.firstVoice != reference.firstVoice)
+            return fail("steal", "the first two notes didn't play");
+        
+        if (stealing.quietestVoice != stealing.firstVoice || ! stealing.thirdStole)
+            return fail("steal", "the quietest voice isn't the one stolen");
+        
+        if (stealing.playing != reference.playing)
+            return fail("steal", "the louder voice is disturbed");
+        
+        return checkFade("steal", stealing.stolen, reference.stolen, thirdNoteOn);
+    }
+    
+    int checkShrink()
+    {
+        auto reference = render(false, false);
+        auto shrinking = render(false, true);
+        
+        if (shrinking.firstVoice != 0 || shrinking.secondVoice != 1)
+            return fail("shrink", "the first two notes didn't play on the first two voices");
+        
+        // both voices past the new pool of none fade
+        auto fadeStart = thirdNoteOn / blockSize * blockSize;
+        return checkFade("shrink", shrinking.stolen, reference.stolen, fadeStart)
+             + checkFade("shrink", shrinking.playing, reference.playing, fadeStart);
+    }
+    
+    int checkChordChange()
+    {
+        auto reference = renderChords(false);
+        auto changing = renderChords(true);
+        
+        if (changing.firstVoices != reference.firstVoices)
+            return fail("chord", "the first chord didn't play");
+        
+        for (auto voice : changing.secondVoices)
+            if (voice < 0)
+                return fail("chord", "a note of the second chord didn't play");
+        
+        auto fadeLength = getFadeLength();
+        auto noteStart = chordChange + fadeLength;
+        int numWaited = 0;
+        
+        for (auto voice : changing.firstVoices)
+        {
+            auto& output = changing.voices[size_t(voice)];
+            auto waited = std::find(changing.secondVoices.begin(), changing.secondVoices.end(), voice) != changing.secondVoices.end();
+            
+            if (checkFade("chord", output, reference.voices[size_t(voice)], chordChange, waited ? noteStart : totalLength) != 0)
+                return 1;
+            
+            if (! waited)
+                continue;
+            
+            // a cleared comb under an attack from zero, where the old gain
+            // jumped back to 1 on the comb's ringing. Through the attack the
+            // note stays under the old one's peak scaled by the envelope
+            auto peak = 0.0f;
+            for (auto sample : reference.voices[size_t(voice)])
+                peak = jmax(peak, std::abs(sample));
+            
+            auto attackLength = roundToInt(chordAttackSeconds * sampleRate);
+            for (int s = 0; s < attackLength; ++s)
+                if (std::abs(output[size_t(noteStart + s)]) > peak * float(s + 1) / float(attackLength))
+                    return fail("chord", "the waiting note starts with a click");
+            
+            auto sounds = false;
+            for (int s = noteStart; s < noteStart + blockSize; ++s)
+                sounds = sounds || output[size_t(s)] != 0.0f;
+            
+            if (! sounds)
+                return fail("chord", "the waiting note never starts");
+            
+            ++numWaited;
+        }
+        
+        if (numWaited != int(std::size(secondChord)) - NUM_STEAL_VOICES)
+            return fail("chord", "the notes past the spares didn't wait on a fade");
+        
+        std::printf("%-12s ok, %d note waited %d samples\n", "chord", numWaited, fadeLength);
+        return 0;
+    }
+}
+
+int main()
+{
+    int numFailures = 0;
+    
+    numFailures += checkSteal();
+    numFailures += checkShrink();
+    numFailures += checkChordChange();
+    
+    return numFailures == 0 ? 0 : 1;
+}